@@ -10,6 +10,7 @@
  #include <sys/mman.h>
  #include <time.h>
  #include "gpio.h"
+ #include "mm-clock.h"
  
  // GPIO memory mapping
  #define BCM2708_PERI_BASE 0x3F000000 // For RPi 2 & 3 (use 0xFE000000 for RPi 4)
@@ -100,9 +101,9 @@
  void blinkLED(int pin, int times) {
      for (int i = 0; i < times; i++) {
          writeLED(pin, 1);
-         usleep(200000); // 0.2 seconds on
+         clockSleepUs(200000); // 0.2 seconds on
          writeLED(pin, 0);
-         usleep(200000); // 0.2 seconds off
+         clockSleepUs(200000); // 0.2 seconds off
      }
  }
  
@@ -114,14 +115,14 @@
  // Wait for button press
  void waitForButton() {
      while (!readButton()) {
-         usleep(10000); // 10ms delay
+         clockSleepUs(10000); // 10ms delay
      }
      
      // Wait for button release
      while (readButton()) {
-         usleep(10000); // 10ms delay
+         clockSleepUs(10000); // 10ms delay
      }
      
      // Debounce
-     usleep(50000); // 50ms delay
+     clockSleepUs(50000); // 50ms delay
  }
\ No newline at end of file
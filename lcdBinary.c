@@ -9,13 +9,22 @@
  #include <fcntl.h>
  #include <sys/mman.h>
  #include <time.h>
+ #include <string.h>
  #include "lcdBinary.h"
+ #include "mm-gtrace.h"
+ #include "mm-clock.h"
+ #include "mm-perf.h"
  
  // GPIO memory mapping
  #define BCM2708_PERI_BASE 0x3F000000 // For RPi 2 & 3 (use 0xFE000000 for RPi 4)
  #define GPIO_BASE (BCM2708_PERI_BASE + 0x200000)
  #define BLOCK_SIZE (4*1024)
  
+ // Left behind by a clean exit: the LCD is still configured for 4-bit mode
+ // (holds the boot id, so a reboot or power cycle invalidates it)
+ #define LCD_MARKER_FILE "/run/mastermind-lcd"
+ #define BOOT_ID_FILE "/proc/sys/kernel/random/boot_id"
+ 
  // GPIO setup macros
  #define INP_GPIO(g) *(gpio+((g)/10)) &= ~(7<<(((g)%10)*3))
  #define OUT_GPIO(g) *(gpio+((g)/10)) |=  (1<<(((g)%10)*3))
@@ -23,6 +32,13 @@
  #define GPIO_CLR *(gpio+10)
  #define GPIO_READ(g) (*(gpio+13)&(1<<g))
  
+ // I/O counters, plain increments on the single I/O thread
+ IoCounters ioCounters;
+ 
+ // The pin-level functions below talk to the real GPIO registers; a build
+ // with -DLCD_SIM gets them from the simulated backend in mm-sim.c instead
+ #ifndef LCD_SIM
+ 
  // Global variables
  static volatile unsigned *gpio;
  static int mem_fd;
@@ -30,6 +46,12 @@
  
  // Initialize GPIO
  int initGPIO() {
+     // The LCD and button timing need real delays
+     if (clockVirtual) {
+         printf("Virtual clock needs the simulated backend (mastermind-sim)\n");
+         return 0;
+     }
+     
      // Open /dev/mem
      if ((mem_fd = open("/dev/mem", O_RDWR|O_SYNC)) < 0) {
          printf("Failed to open /dev/mem\n");
@@ -77,27 +99,77 @@
      digitalWrite(GREEN_LED, 0);
      digitalWrite(RED_LED, 0);
      
+     // A running GPIO capture still reads the mapping
+     gtraceStop();
+     
      // Unmap memory
      munmap(gpio_map, BLOCK_SIZE);
      close(mem_fd);
  }
  
+ // Set both LEDs with one GPSET0 and one GPCLR0 store, so they switch together
+ void writeLEDs(int green, int red) {
+     unsigned set = (green ? 1u << GREEN_LED : 0) | (red ? 1u << RED_LED : 0);
+     unsigned clr = ((1u << GREEN_LED) | (1u << RED_LED)) & ~set;
+     ioCounters.gpioWrites++;
+     
+     __asm__ __volatile__(
+         "str %[set], [%[gpio], #28];"  // GPSET0 = gpio + 7*4
+         "str %[clr], [%[gpio], #40];"  // GPCLR0 = gpio + 10*4
+         :
+         : [set] "r" (set), [clr] "r" (clr), [gpio] "r" (gpio)
+         : "memory"
+     );
+     GTRACE_WRITE(GREEN_LED, green);
+     GTRACE_WRITE(RED_LED, red);
+ }
+ 
+ // Raw GPSET0/GPCLR0 stores of whole masks, for display list replay
+ void writePins(unsigned set, unsigned clr) {
+     ioCounters.gpioWrites++;
+     
+     __asm__ __volatile__(
+         "str %[set], [%[gpio], #28];"  // GPSET0 = gpio + 7*4
+         "str %[clr], [%[gpio], #40];"  // GPCLR0 = gpio + 10*4
+         :
+         : [set] "r" (set), [clr] "r" (clr), [gpio] "r" (gpio)
+         : "memory"
+     );
+     if (gtraceEnabled) {
+         for (unsigned bits = set | clr; bits != 0; bits &= bits - 1) {
+             int pin = __builtin_ctz(bits);
+             gtraceWrite(pin, (set >> pin) & 1);
+         }
+     }
+ }
+ 
+ // The live register mapping, for the GPIO trace sampler (NULL before initGPIO)
+ volatile unsigned* gpioRegisters() {
+     return gpio;
+ }
+ 
+ // Drive the register functions against plain memory instead of /dev/mem,
+ // so mm-iprof can count their instructions under qemu-user
+ void gpioUseRegisters(volatile unsigned* regs) {
+     gpio = regs;
+ }
+ 
  // Set pin mode (INPUT or OUTPUT)
  void pinMode(int pin, int mode) {
+     // GPFSELn holds 3 bits for each of 10 pins; the ARMv6 cores have no
+     // divide instruction, so the register and shift are worked out in C
+     volatile unsigned* fsel = gpio + pin / 10;
+     int shift = (pin % 10) * 3;
+     
      // Using inline assembly for direct GPIO register access
      __asm__ __volatile__(
-         "mov r0, %[pin];"        // Move pin number to r0
          "mov r1, %[mode];"       // Move mode to r1
-         "ldr r2, =%[gpio];"      // Load GPIO base address
-         "ldr r2, [r2];"          // Dereference to get actual address
-         "mov r3, r0, lsr #3;"    // r3 = pin / 10 (actually /8 then *4 for word offset)
-         "add r2, r2, r3, lsl #2;" // r2 = gpio + (pin/10)*4
-         "and r3, r0, #0x1F;"     // r3 = pin % 32
-         "mov r3, r3, lsl #1;"    // r3 = (pin % 32) * 2 (2 bits per pin)
+         "mov r2, %[fsel];"       // r2 = gpio + (pin/10)*4
+         "mov r3, %[shift];"      // r3 = (pin % 10) * 3
          "ldr r4, [r2];"          // r4 = current register value
-         "mov r0, #0x3;"          // r0 = 0x3 (mask for 2 bits)
+         "mov r0, #0x7;"          // r0 = 0x7 (mask for 3 bits)
          "mov r0, r0, lsl r3;"    // r0 = mask shifted to pin position
-         "bic r4, r4, r0;"        // Clear the 2 bits for this pin
+         "bic r4, r4, r0;"        // Clear the 3 bits for this pin
          "cmp r1, #0;"            // Check if mode is INPUT (0)
          "beq 1f;"                // If INPUT, skip next instruction
          "mov r0, #0x1;"          // r0 = 0x1 (OUTPUT mode)
@@ -105,19 +177,22 @@
          "orr r4, r4, r0;"        // Set the mode bits
          "1: str r4, [r2];"       // Store back to GPIO register
          :
-         : [pin] "r" (pin), [mode] "r" (mode), [gpio] "r" (gpio)
+         : [mode] "r" (mode), [fsel] "r" (fsel), [shift] "r" (shift)
          : "r0", "r1", "r2", "r3", "r4", "memory"
      );
  }
  
  // Write digital value to pin
  void digitalWrite(int pin, int value) {
+     PerfMark perf;
+     PERF_BEGIN(&perf);
+     ioCounters.gpioWrites++;
+     
      // Using inline assembly for direct GPIO register access
      __asm__ __volatile__(
          "mov r0, %[pin];"        // Move pin number to r0
          "mov r1, %[value];"      // Move value to r1
-         "ldr r2, =%[gpio];"      // Load GPIO base address
-         "ldr r2, [r2];"          // Dereference to get actual address
+         "mov r2, %[gpio];"       // Load GPIO base address
          "mov r3, #1;"            // r3 = 1
          "mov r3, r3, lsl r0;"    // r3 = 1 << pin
          "cmp r1, #0;"            // Check if value is 0
@@ -130,6 +205,8 @@
          : [pin] "r" (pin), [value] "r" (value), [gpio] "r" (gpio)
          : "r0", "r1", "r2", "r3", "memory"
      );
+     GTRACE_WRITE(pin, value);
+     PERF_END(&perf, PERF_DIGITAL_WRITE);
  }
  
  // Read digital value from pin
@@ -139,8 +216,7 @@
      // Using inline assembly for direct GPIO register access
      __asm__ __volatile__(
          "mov r0, %[pin];"        // Move pin number to r0
-         "ldr r1, =%[gpio];"      // Load GPIO base address
-         "ldr r1, [r1];"          // Dereference to get actual address
+         "mov r1, %[gpio];"       // Load GPIO base address
          "add r1, r1, #52;"       // r1 = gpio + 13*4 (LEV0 register)
          "ldr r2, [r1];"          // r2 = current register value
          "mov r3, #1;"            // r3 = 1
@@ -157,6 +233,8 @@
      return result;
  }
  
+ #endif // LCD_SIM
+ 
  // Write to LED (blink)
  void writeLED(int pin, int value) {
      digitalWrite(pin, value);
@@ -166,36 +244,31 @@
  void blinkLED(int pin, int times) {
      for (int i = 0; i < times; i++) {
          writeLED(pin, 1);
-         usleep(200000); // 0.2 seconds on
+         clockSleepUs(200000); // 0.2 seconds on
          writeLED(pin, 0);
-         usleep(200000); // 0.2 seconds off
+         clockSleepUs(200000); // 0.2 seconds off
      }
  }
  
  // Read button state
  int readButton() {
+     ioCounters.buttonReads++;
      return digitalRead(BUTTON);
  }
  
  // Wait for button press
  void waitForButton() {
      while (!readButton()) {
-         usleep(10000); // 10ms delay
+         clockSleepUs(10000); // 10ms delay
      }
      
      // Wait for button release
      while (readButton()) {
-         usleep(10000); // 10ms delay
-     }
-     
-     // Debounce
-     usleep(50000); // 50ms delay
- }  {
-         usleep(10000); // 10ms delay
+         clockSleepUs(10000); // 10ms delay
      }
      
      // Debounce
-     usleep(50000); // 50ms delay
+     clockSleepUs(50000); // 50ms delay
  }
  
  // LCD functions
@@ -208,13 +281,17 @@
      
      // Toggle enable pin
      digitalWrite(LCD_EN, 1);
-     usleep(1);
+     clockSleepUs(1);
      digitalWrite(LCD_EN, 0);
-     usleep(1);
+     clockSleepUs(1);
  }
  
  // Send 8-bit command to LCD
  void lcdByte(unsigned char byte, int mode) {
+     PerfMark perf;
+     PERF_BEGIN(&perf);
+     ioCounters.lcdBytes++;
+     
      // Set RS pin for command (0) or data (1)
      digitalWrite(LCD_RS, mode);
      
@@ -225,31 +302,37 @@
      lcdNibble(byte & 0x0F);
      
      // Wait for command to execute
-     usleep(100);
+     clockSleepUs(100);
+     PERF_END(&perf, PERF_LCD_BYTE);
  }
  
  // Initialize LCD
  int initLCD() {
      // Wait for LCD to power up
-     usleep(50000);
+     clockSleepUs(LCD_POWERUP_US);
      
+     return configureLCD();
+ }
+ 
+ // Run the 4-bit init sequence, for a controller that is already powered up
+ int configureLCD() {
      // Initialize in 4-bit mode
      digitalWrite(LCD_RS, 0);
      lcdNibble(0x03);
-     usleep(5000);
+     clockSleepUs(5000);
      lcdNibble(0x03);
-     usleep(100);
+     clockSleepUs(100);
      lcdNibble(0x03);
-     usleep(100);
+     clockSleepUs(100);
      lcdNibble(0x02); // Set to 4-bit mode
-     usleep(100);
+     clockSleepUs(100);
      
      // Configure display
      lcdByte(0x28, 0); // 4-bit mode, 2 lines, 5x8 font
      lcdByte(0x0C, 0); // Display on, cursor off, blink off
      lcdByte(0x06, 0); // Increment cursor, no shift
      lcdByte(0x01, 0); // Clear display
-     usleep(2000);     // Wait for clear to complete
+     clockSleepUs(2000);     // Wait for clear to complete
      
      return 1;
  }
@@ -257,7 +340,7 @@
  // Clear LCD display
  void clearLCD() {
      lcdByte(0x01, 0); // Clear display command
-     usleep(2000);     // Wait for clear to complete
+     clockSleepUs(2000);     // Wait for clear to complete
  }
  
  // Write string to LCD
@@ -277,4 +360,67 @@
  void writeLineToLCD(const char* str, int line) {
      setCursorLCD(line, 0);
      writeStringToLCD(str);
- }
\ No newline at end of file
+ }
+ 
+ // Write a single character code at the cursor
+ // (codes 8-15 mirror the CGRAM glyphs 0-7 and avoid the '\0' terminator)
+ void writeCharLCD(unsigned char c) {
+     lcdByte(c, 1);
+ }
+ 
+ // Shift the whole display one column, DDRAM contents stay in place
+ void shiftDisplayLCD(int right) {
+     lcdByte(right ? 0x1C : 0x18, 0); // Cursor/display shift with S/C=1
+ }
+ 
+ // Undo any display shift and move the cursor home
+ void homeLCD() {
+     lcdByte(0x02, 0); // Return home command
+     clockSleepUs(2000);     // Wait for return home to complete
+ }
+ 
+ // Load a custom 5x8 glyph into CGRAM slot 0-7
+ void defineCharLCD(int slot, const unsigned char rows[8]) {
+     lcdByte(0x40 | ((slot & 7) << 3), 0); // Set CGRAM address
+     for (int i = 0; i < 8; i++) {
+         lcdByte(rows[i] & 0x1F, 1);
+     }
+     lcdByte(0x80, 0); // Back to DDRAM address 0
+ }
+ 
+ #ifndef LCD_SIM
+ 
+ // Read the boot id into buf, returns its length or 0
+ static int readBootId(char* buf, int size) {
+     FILE* f = fopen(BOOT_ID_FILE, "r");
+     if (f == NULL) return 0;
+     if (fgets(buf, size, f) == NULL) buf[0] = '\0';
+     fclose(f);
+     return strlen(buf);
+ }
+ 
+ // Check for (and consume) the marker of a previous clean exit.
+ // Consuming it means a crash mid-command never leaves a stale marker.
+ int lcdMarkerValid() {
+     char marker[64] = "", bootId[64] = "";
+     FILE* f = fopen(LCD_MARKER_FILE, "r");
+     if (f == NULL) return 0;
+     if (fgets(marker, sizeof(marker), f) == NULL) marker[0] = '\0';
+     fclose(f);
+     unlink(LCD_MARKER_FILE);
+     
+     return readBootId(bootId, sizeof(bootId)) > 0 && strcmp(marker, bootId) == 0;
+ }
+ 
+ // Record that the LCD is configured, call only once no command is in flight
+ void lcdWriteMarker() {
+     char bootId[64];
+     if (readBootId(bootId, sizeof(bootId)) == 0) return;
+     
+     FILE* f = fopen(LCD_MARKER_FILE, "w");
+     if (f == NULL) return;
+     fputs(bootId, f);
+     fclose(f);
+ }
+ 
+ #endif // LCD_SIM
@@ -23,23 +23,45 @@
  #define LCD_D6 27
  #define LCD_D7 22
  
+ // I/O counters, published by the shared-memory state snapshot
+ typedef struct {
+     unsigned long gpioWrites;
+     unsigned long lcdBytes;
+     unsigned long buttonReads;
+ } IoCounters;
+ extern IoCounters ioCounters;
+ 
  // Function prototypes for GPIO
  int initGPIO();
  void cleanupGPIO();
  void pinMode(int pin, int mode);
  void digitalWrite(int pin, int value);
  int digitalRead(int pin);
+ volatile unsigned* gpioRegisters();
+ void gpioUseRegisters(volatile unsigned* regs);
  void writeLED(int pin, int value);
+ void writeLEDs(int green, int red);
+ void writePins(unsigned set, unsigned clr);
  void blinkLED(int pin, int times);
  int readButton();
  void waitForButton();
  
+ // LCD power-up wait before the first command
+ #define LCD_POWERUP_US 50000
+ 
  // Function prototypes for LCD
  int initLCD();
+ int configureLCD();
+ int lcdMarkerValid();
+ void lcdWriteMarker();
  void clearLCD();
  void writeStringToLCD(const char* str);
  void setCursorLCD(int row, int col);
  void writeLineToLCD(const char* str, int line);
+ void writeCharLCD(unsigned char c);
+ void shiftDisplayLCD(int right);
+ void homeLCD();
+ void defineCharLCD(int slot, const unsigned char rows[8]);
  
  // Function prototype for assembly function
  extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
@@ -12,12 +12,34 @@
  #include <pthread.h>
  #include <signal.h>
  #include "lcdBinary.h"
+ #include "mm-trace.h"
+ #include "mm-batch.h"
+ #include "mm-server.h"
+ #include "mm-rng.h"
+ #include "mm-rt.h"
+ #include "mm-shm.h"
+ #include "mm-gtrace.h"
+ #include "mm-clock.h"
+ #include "mm-cset.h"
+ #include "mm-tcache.h"
+ #include "mm-perf.h"
+ #include "mm-arena.h"
+ #include "mm-led.h"
+ #include "mm-dlists.h"
+ #include "mm-multi.h"
  
  // Game parameters
  #define CODE_LENGTH 3
  #define NUM_COLORS 3
  #define MAX_ATTEMPTS 10
  #define TIMEOUT_SECONDS 10
+ #define MULTI_DEFAULT 4       // Secrets in a tournament without -M
+ 
+ // History view: each entry takes 3 pegs + 1 score glyph of the 40-column DDRAM line
+ #define HISTORY_COLS (CODE_LENGTH + 1)
+ #define LCD_VISIBLE_COLS 16
+ #define HISTORY_HOLD_MS 1000  // Long press leaves the history view
+ #define HISTORY_IDLE_MS 3000  // So does leaving the button alone
  
  // LED pins
  #define RED_LED 5
@@ -37,28 +59,68 @@
  void displayAnswer(int exactMatches, int approxMatches);
  void displaySuccess(int attempts);
  void displayGameOver(int* secret);
+ int playMultiGame(int count);
  void signalNextRound(void);
+ void initHistoryGlyphs(void);
+ void recordHistory(int* guess, int exactMatches, int approxMatches);
+ void browseHistory(void);
+ int sleepUnlessPressed(int ms);
+ double nowMs(void);
  extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
  void runUnitTests(const char* seq1, const char* seq2);
  
  // Thread function for handling timeout
  void* timeoutThread(void* arg);
  
+ // Startup stages that run concurrently, see main
+ typedef struct {
+     int gpioOk;
+     double gpioMs, secretMs, hintMs;
+     int* secret;
+     const char* predefinedSecret;
+     const char* hintPath;   // -h file, NULL without hints
+     TCache* hintCache;      // Created and loaded from hintPath
+ } StartupState;
+ void* startupGpioThread(void* arg);
+ void* startupSecretThread(void* arg);
+ 
  // Global variables
  volatile sig_atomic_t timeoutOccurred = 0;
  int verboseMode = 0;
  int debugMode = 0;
+ int historyMode = 0;
+ int multiCount = 0;   // Secrets played at once with -M, 0 for the normal game
+ 
+ // Helper threads run on normal scheduling, even with -R
+ pthread_attr_t helperAttr;
+ 
+ // Random stream for secrets, seeded from the clock or with -r
+ Rng gameRng;
+ 
+ // Past guesses and scores, shown by the history view
+ int historyGuess[MAX_ATTEMPTS][CODE_LENGTH];
+ int historyExact[MAX_ATTEMPTS], historyApprox[MAX_ATTEMPTS];
+ int historyCount = 0;
+ 
+ // CGRAM character code for each (exact, approx) score, 0 if none
+ unsigned char scoreGlyph[CODE_LENGTH + 1][CODE_LENGTH + 1];
  
  int main(int argc, char *argv[]) {
      // Initialize random seed
-     srand(time(NULL));
+     rngSeed(&gameRng, time(NULL));
      
      // Parse command-line arguments
      int opt;
      char *predefinedSecret = NULL;
      char *seq1 = NULL, *seq2 = NULL;
-     
-     while ((opt = getopt(argc, argv, "vds:u:")) != -1) {
+     char *batchPath = NULL;
+     char *serverPath = NULL;
+     char *gtracePath = NULL;
+     char *hintPath = NULL;
+     int rtMode = 0, jitterProbe = 0, virtualClock = 0;
+     int tournamentGames = 0;
+     
+     while ((opt = getopt(argc, argv, "vdtHRJVPSs:u:b:D:r:g:h:L:M:T:")) != -1) {
          switch (opt) {
              case 'v':
                  verboseMode = 1;
@@ -66,10 +128,64 @@
              case 'd':
                  debugMode = 1;
                  break;
+             case 't':
+                 traceInit();
+                 break;
+             case 'H':
+                 historyMode = 1;
+                 break;
+             case 'R':
+                 rtMode = 1;
+                 break;
+             case 'J':
+                 jitterProbe = 1;
+                 break;
+             case 'V':
+                 virtualClock = 1;
+                 break;
+             case 'P':
+                 perfInit(1);
+                 break;
+             case 'S':
+                 dlBytewise = 1;
+                 break;
              case 's':
                  predefinedSecret = optarg;
                  break;
+             case 'r':
+                 rngSeed(&gameRng, strtoull(optarg, NULL, 10));
+                 break;
+             case 'b':
+                 batchPath = optarg;
+                 break;
+             case 'D':
+                 serverPath = optarg;
+                 break;
+             case 'g':
+                 gtracePath = optarg;
+                 break;
+             case 'h':
+                 hintPath = optarg;
+                 break;
+             case 'L':
+                 if (!ledModeParse(optarg)) return 1;
+                 break;
+             case 'M':
+                 multiCount = atoi(optarg);
+                 if (multiCount < 1 || multiCount > MULTI_MAX) {
+                     fprintf(stderr, "Error: -M takes 1 to %d secrets.\n", MULTI_MAX);
+                     return 1;
+                 }
+                 break;
+             case 'T':
+                 tournamentGames = atoi(optarg);
+                 break;
              case 'u':
+                 // "-u -" scores a stream of pairs from stdin
+                 if (strcmp(optarg, "-") == 0) {
+                     batchPath = optarg;
+                     break;
+                 }
                  seq1 = optarg;
                  seq2 = argv[optind]; // Next argument after -u
                  if (seq2 == NULL) {
@@ -79,28 +195,114 @@
                  optind++; // Advance past the second sequence
                  break;
              default:
-                 fprintf(stderr, "Usage: %s [-v] [-d] [-s <seq>] [-u <seq1> <seq2>]\n", argv[0]);
+                 fprintf(stderr, "Usage: %s [-v] [-d] [-t] [-H] [-R] [-J] [-V] [-P] [-S] [-r <seed>] [-s <seq>] [-u <seq1> <seq2>] [-b <file>] [-D <socket>] [-g <file>] [-h <file>] [-L blink|pwm|pulse] [-M <secrets>] [-T <games>]\n", argv[0]);
                  return 1;
          }
      }
  
-     // Initialize GPIO
-     if (!initGPIO()) {
+     // Every delay goes through this clock; virtual time runs a simulated
+     // game as fast as the CPU allows
+     clockInit(virtualClock);
+     
+     // Batch mode never touches the hardware
+     if (batchPath != NULL) {
+         return runBatch(batchPath, CODE_LENGTH, NUM_COLORS) ? 0 : 1;
+     }
+     
+     // So does the game server
+     if (serverPath != NULL) {
+         return runServer(serverPath, CODE_LENGTH, NUM_COLORS, MAX_ATTEMPTS, rngNext(&gameRng)) ? 0 : 1;
+     }
+     
+     // And so does tournament play of the multi-secret game
+     if (tournamentGames > 0) {
+         return runTournament(tournamentGames, multiCount > 0 ? multiCount : MULTI_DEFAULT,
+                              CODE_LENGTH, NUM_COLORS, rngNext(&gameRng)) ? 0 : 1;
+     }
+     
+     // Jitter probe: wake-up latency with real-time mode off, then on
+     if (jitterProbe) {
+         rtJitterProbe(stdout, "(off)", RT_PROBE_SAMPLES, RT_PROBE_PERIOD_US);
+         rtEnable(-1, 1);
+         rtJitterProbe(stdout, "(on)", RT_PROBE_SAMPLES, RT_PROBE_PERIOD_US);
+         return 0;
+     }
+     
+     // Real-time mode for this (the I/O) thread only; falls back to normal
+     // scheduling without privileges. Helper threads are created with
+     // helperAttr, so they stay on SCHED_OTHER and may use every core
+     if (rtMode) {
+         rtEnable(-1, verboseMode);
+     }
+     rtHelperAttr(&helperAttr);
+     
+     // Game variables
+     int secret[CODE_LENGTH];
+     int guess[CODE_LENGTH];
+     int exactMatches, approxMatches;
+     int attempts = 0;
+     int gameWon = 0;
+     
+     // Startup runs as a small dependency graph: GPIO mapping, the LCD
+     // power-up wait and secret generation with hint-cache loading overlap,
+     // and LCD configuration waits for the first two (or is skipped if the
+     // LCD is still set up)
+     double startupStart = nowMs();
+     StartupState startup = { 0, 0.0, 0.0, 0.0, secret, predefinedSecret, hintPath, NULL };
+     pthread_t gpio_thread, secret_thread;
+     int gpioThreaded, secretThreaded = 0;
+     int lcdConfigured = lcdMarkerValid();
+     
+     gpioThreaded = pthread_create(&gpio_thread, &helperAttr, startupGpioThread, &startup) == 0;
+     if (seq1 == NULL) {
+         secretThreaded = pthread_create(&secret_thread, &helperAttr, startupSecretThread, &startup) == 0;
+     }
+     
+     // Wait for LCD to power up, unless it is already configured
+     if (!lcdConfigured) {
+         clockSleepUs(LCD_POWERUP_US);
+     }
+     
+     // Run any stage that could not get a thread inline
+     if (gpioThreaded) {
+         pthread_join(gpio_thread, NULL);
+     } else {
+         startupGpioThread(&startup);
+     }
+     if (secretThreaded) {
+         pthread_join(secret_thread, NULL);
+     } else if (seq1 == NULL) {
+         startupSecretThread(&startup);
+     }
+     
+     if (!startup.gpioOk) {
          printf("Failed to initialize GPIO\n");
          return 1;
      }
      
-     // Set up pins
-     pinMode(GREEN_LED, OUTPUT);
-     pinMode(RED_LED, OUTPUT);
-     pinMode(BUTTON_PIN, INPUT);
+     // Pin-level capture, started before the LCD init to see its bus timing
+     if (gtracePath != NULL) {
+         gtraceStart(gtracePath, gpioRegisters(), GTRACE_PERIOD_NS);
+     }
      
      // Initialize LCD
-     if (!initLCD()) {
+     double lcdStart = nowMs();
+     if (!lcdConfigured && !configureLCD()) {
          printf("Failed to initialize LCD\n");
          cleanupGPIO();
          return 1;
      }
+     double lcdMs = nowMs() - lcdStart;
+     
+     if (verboseMode) {
+         double serialMs = startup.gpioMs + startup.secretMs + startup.hintMs + lcdMs +
+                           (lcdConfigured ? 0 : LCD_POWERUP_US / 1000.0);
+         printf("Startup: gpio %.1f ms, secret %.1f ms, hints %.1f ms, lcd %.1f ms%s\n",
+                startup.gpioMs, startup.secretMs, startup.hintMs, lcdMs,
+                lcdConfigured ? " (already configured)" : "");
+         printf("Startup: ready after %.1f ms (serial estimate %.1f ms)\n",
+                nowMs() - startupStart, serialMs);
+     }
      
      // Initialize LCD mutex
      if (pthread_mutex_init(&lcd_mutex, NULL) != 0) {
@@ -112,15 +314,39 @@
      // Handle unit test mode
      if (seq1 != NULL && seq2 != NULL) {
          runUnitTests(seq1, seq2);
+         lcdWriteMarker();
          cleanupGPIO();
          pthread_mutex_destroy(&lcd_mutex);
          return 0;
      }
      
+     // Publish the live game state for dashboards (best effort)
+     shmPublishInit(CODE_LENGTH, MAX_ATTEMPTS, &ioCounters);
+     
+     // Per-game state comes from this arena, so playing never calls malloc
+     Arena gameArena;
+     if (!arenaCreate(&gameArena, ARENA_GAME_BYTES)) {
+         cleanupGPIO();
+         return 1;
+     }
+     arenaBind(&gameArena);
+     
+     // Hint mode: track the codes still possible and suggest the best guess,
+     // with best guesses cached in hintPath between games (loaded at startup)
+     TCache* hintCache = startup.hintCache;
+     Cset* hintCands = NULL;
+     if (hintPath != NULL) {
+         hintCands = csetFull(CODE_LENGTH, NUM_COLORS);
+     }
+     
+     // Load the score glyphs for the history view and the multi-secret
+     // summary (CGRAM survives clearLCD)
+     if (historyMode || multiCount > 0) {
+         initHistoryGlyphs();
+     }
+     
      // Clear LCD and display welcome message
-     clearLCD();
-     writeLineToLCD("MasterMind Game", 0);
-     writeLineToLCD("Press to start", 1);
+     dlShow(&dlScreens[SCREEN_WELCOME]);
      
      // Wait for button press to start
      waitForButton();
@@ -129,36 +355,41 @@
      const char* surname = "Smith"; // Replace with your surname
      displayGreeting(surname);
      
-     // Game variables
-     int secret[CODE_LENGTH];
-     int guess[CODE_LENGTH];
-     int exactMatches, approxMatches;
-     int attempts = 0;
-     int gameWon = 0;
-     
-     // Generate secret code
-     generateSecret(secret, predefinedSecret);
-     
      // Debug mode - show secret
      if (debugMode) {
-         clearLCD();
-         char secretStr[20];
-         sprintf(secretStr, "Secret: %d %d %d", secret[0], secret[1], secret[2]);
-         writeLineToLCD(secretStr, 0);
-         writeLineToLCD("Game starting...", 1);
-         sleep(2);
+         dlPatchf(&dlScreens[SCREEN_SECRET], 0, "%d %d %d", secret[0], secret[1], secret[2]);
+         dlShow(&dlScreens[SCREEN_SECRET]);
+         clockSleepMs(2000);
+     }
+     
+     // Multi-secret game: the normal loop below does not run
+     arenaNoMalloc = 1;
+     if (multiCount > 0) {
+         gameWon = playMultiGame(multiCount);
      }
      
      // Game loop
-     while (!gameWon && attempts < MAX_ATTEMPTS) {
+     while (multiCount == 0 && !gameWon && attempts < MAX_ATTEMPTS) {
          attempts++;
+         shmSetAttempt(attempts);
          
-         // Display attempt number on LCD
-         clearLCD();
-         char attemptStr[20];
-         sprintf(attemptStr, "Attempt %d/%d", attempts, MAX_ATTEMPTS);
-         writeLineToLCD(attemptStr, 0);
-         writeLineToLCD("Enter your guess", 1);
+         // Display attempt number on LCD, with a hint on line 1 in hint mode
+         int hint[CODE_LENGTH];
+         uint64_t hintBound;
+         if (hintCands != NULL && tcacheHint(hintCache, hintCands, MAX_ATTEMPTS - attempts + 1, hint, &hintBound)) {
+             DisplayList* screen = &dlScreens[SCREEN_ATTEMPT_HINT];
+             dlPatchf(screen, 0, "%d/%d", attempts, MAX_ATTEMPTS);
+             dlPatchf(screen, 1, "%d %d %d", hint[0], hint[1], hint[2]);
+             dlShow(screen);
+             if (verboseMode) {
+                 printf("Hint: %d %d %d (%llu codes possible, at most %llu left after it)\n",
+                        hint[0], hint[1], hint[2], (unsigned long long)csetCardinality(hintCands),
+                        (unsigned long long)hintBound);
+             }
+         } else {
+             dlPatchf(&dlScreens[SCREEN_ATTEMPT], 0, "%d/%d", attempts, MAX_ATTEMPTS);
+             dlShow(&dlScreens[SCREEN_ATTEMPT]);
+         }
          
          // Get user's guess
          getUserGuess(guess);
@@ -167,27 +398,55 @@
          displayGuess(guess);
          
          // Calculate matches using assembly function
+         PerfMark perf;
+         PERF_BEGIN(&perf);
          matchesASM(secret, guess, CODE_LENGTH, &exactMatches, &approxMatches);
+         PERF_END(&perf, PERF_MATCH_GAME);
+         shmSetScore(exactMatches, approxMatches);
          
          // Display answer
          displayAnswer(exactMatches, approxMatches);
+         recordHistory(guess, exactMatches, approxMatches);
+         if (hintCands != NULL) {
+             Cset* next = csetFilter(hintCands, guess, exactMatches, approxMatches);
+             if (next != NULL) {
+                 csetFree(hintCands);
+                 hintCands = next;
+             }
+         }
          
          // Check if game is won
          if (exactMatches == CODE_LENGTH) {
              gameWon = 1;
+             shmSetPhase(SHM_PHASE_WON);
              displaySuccess(attempts);
          } else {
+             // Let the player look back over the board
+             if (historyMode) {
+                 browseHistory();
+             }
+             
              // Signal start of next round
              signalNextRound();
          }
      }
      
      // If game is lost
-     if (!gameWon) {
+     if (!gameWon && multiCount == 0) {
+         shmSetPhase(SHM_PHASE_LOST);
          displayGameOver(secret);
      }
+     arenaNoMalloc = 0;
      
-     // Clean up GPIO
+     if (hintCache != NULL) {
+         tcacheSave(hintCache, hintPath);
+         tcacheFree(hintCache);
+     }
+     csetFree(hintCands);
+     arenaDestroy(&gameArena);
+     
+     // Clean up GPIO, the LCD stays configured for the next run
+     lcdWriteMarker();
      cleanupGPIO();
      
      // Destroy LCD mutex
@@ -196,11 +455,9 @@
      return 0;
  }
  
- // Display greeting based on surname
+ // Display greeting based on surname, a button press skips the rest of it
  void displayGreeting(const char* surname) {
-     clearLCD();
-     writeLineToLCD("Welcome to", 0);
-     writeLineToLCD("MasterMind!", 1);
+     dlShow(&dlScreens[SCREEN_GREETING]);
      
      // Blink LEDs based on surname (first 5 letters)
      int len = strlen(surname);
@@ -217,11 +474,67 @@
          } else {
              blinkLED(RED_LED, 1);   // Consonant - blink red once
          }
-         usleep(500000); // 0.5 second pause
+         if (sleepUnlessPressed(500)) return; // 0.5 second pause
      }
      
      // Pause after greeting
-     sleep(2);
+     sleepUnlessPressed(2000);
+ }
+ 
+ // Sleep for up to ms milliseconds, returns 1 early if the button is pressed.
+ // The press is consumed, so it does not count as guess input.
+ int sleepUnlessPressed(int ms) {
+     for (int waited = 0; waited < ms; waited += 10) {
+         if (readButton()) {
+             while (readButton()) {
+                 clockSleepUs(10000); // 10ms delay
+             }
+             clockSleepUs(50000); // Debounce
+             return 1;
+         }
+         clockSleepUs(10000); // 10ms delay
+     }
+     return 0;
+ }
+ 
+ // Monotonic time in milliseconds
+ double nowMs(void) {
+     return clockNowNs() / 1000000.0;
+ }
+ 
+ // Startup stage: map GPIO and set up the pins
+ void* startupGpioThread(void* arg) {
+     StartupState* st = (StartupState*)arg;
+     double start = nowMs();
+     
+     st->gpioOk = initGPIO();
+     if (st->gpioOk) {
+         pinMode(GREEN_LED, OUTPUT);
+         pinMode(RED_LED, OUTPUT);
+         pinMode(BUTTON_PIN, INPUT);
+     }
+     st->gpioMs = nowMs() - start;
+     return NULL;
+ }
+ 
+ // Startup stage: generate the secret, then create the hint cache and load
+ // it from the -h file if there is one
+ void* startupSecretThread(void* arg) {
+     StartupState* st = (StartupState*)arg;
+     double start = nowMs();
+     
+     generateSecret(st->secret, st->predefinedSecret);
+     st->secretMs = nowMs() - start;
+     
+     if (st->hintPath != NULL) {
+         start = nowMs();
+         st->hintCache = tcacheCreate(TCACHE_DEFAULT_BYTES);
+         if (st->hintCache != NULL && access(st->hintPath, F_OK) == 0) {
+             tcacheLoad(st->hintCache, st->hintPath);
+         }
+         st->hintMs = nowMs() - start;
+     }
+     return NULL;
  }
  
  // Generate random secret code
@@ -238,14 +551,12 @@
                  }
              } else {
                  // If predefined secret is too short, fill with random values
-                 secret[i] = (rand() % NUM_COLORS) + 1;
+                 secret[i] = rngBounded(&gameRng, NUM_COLORS) + 1;
              }
          }
      } else {
-         // Generate random secret code
-         for (int i = 0; i < CODE_LENGTH; i++) {
-             secret[i] = (rand() % NUM_COLORS) + 1; // 1 to NUM_COLORS
-         }
+         // Generate random secret code, colours 1 to NUM_COLORS
+         rngSecrets(&gameRng, secret, 1, CODE_LENGTH, NUM_COLORS);
      }
      
      if (verboseMode) {
@@ -268,14 +579,13 @@
          count = 0;
          
          // Display prompt on LCD
-         clearLCD();
-         char promptStr[20];
-         sprintf(promptStr, "Enter digit %d:", i + 1);
-         writeLineToLCD(promptStr, 0);
-         writeLineToLCD("Press button", 1);
+         dlPatchf(&dlScreens[SCREEN_ENTER_DIGIT], 0, "%d", i + 1);
+         dlShow(&dlScreens[SCREEN_ENTER_DIGIT]);
          
-         // Create timeout thread
-         if (pthread_create(&timeout_thread, NULL, timeoutThread, NULL) != 0) {
+         // Create timeout thread (counted by the clock before it starts)
+         clockThreadBegin();
+         if (pthread_create(&timeout_thread, &helperAttr, timeoutThread, NULL) != 0) {
+             clockThreadEnd();
              perror("Failed to create timeout thread");
              exit(EXIT_FAILURE);
          }
@@ -283,29 +593,32 @@
          // Wait for button presses or timeout
          while (count < NUM_COLORS && !timeoutOccurred) {
              if (readButton()) {
+                 TRACE(TRACE_PRESS);
                  count++;
+                 shmSetDigit(i, count);
                  
                  // Acknowledge input with red LED
                  blinkLED(RED_LED, 1);
                  
                  // Echo the input value with green LED
                  blinkLED(GREEN_LED, count);
+                 TRACE(TRACE_ECHO);
                  
                  // Debounce
                  while (readButton()) {
-                     usleep(10000); // 10ms delay
+                     clockSleepUs(10000); // 10ms delay
                  }
-                 usleep(50000); // 50ms delay
+                 clockSleepUs(50000); // 50ms delay
+                 TRACE(TRACE_DEBOUNCE);
                  
                  // Update LCD with current count
-                 char countStr[20];
-                 sprintf(countStr, "Count: %d", count);
-                 
                  pthread_mutex_lock(&lcd_mutex);
-                 writeLineToLCD(countStr, 1);
+                 dlPatchf(&dlScreens[SCREEN_COUNT], 0, "%d", count);
+                 dlShow(&dlScreens[SCREEN_COUNT]);
                  pthread_mutex_unlock(&lcd_mutex);
+                 TRACE(TRACE_DISPLAY);
              }
-             usleep(10000); // 10ms delay
+             clockSleepUs(10000); // 10ms delay
          }
          
          // Cancel timeout thread
@@ -316,13 +629,12 @@
          if (count < 1) count = 1;
          if (count > NUM_COLORS) count = NUM_COLORS;
          guess[i] = count;
+         shmSetDigit(i, count);
          
          // Display selected digit
-         char digitStr[20];
-         sprintf(digitStr, "Digit %d: %d", i + 1, guess[i]);
-         clearLCD();
-         writeLineToLCD(digitStr, 0);
-         writeLineToLCD("Press for next", 1);
+         dlPatchf(&dlScreens[SCREEN_DIGIT], 0, "%d", i + 1);
+         dlPatchf(&dlScreens[SCREEN_DIGIT], 1, "%d", guess[i]);
+         dlShow(&dlScreens[SCREEN_DIGIT]);
          
          // Wait for button press to continue
          if (i < CODE_LENGTH - 1) {
@@ -344,44 +656,40 @@
  
  // Thread function for handling timeout
  void* timeoutThread(void* arg) {
-     sleep(TIMEOUT_SECONDS);
+     clockSleepMs(TIMEOUT_SECONDS * 1000);
      timeoutOccurred = 1;
+     clockThreadEnd();
      pthread_exit(NULL);
      return NULL; // Suppress compiler warning
  }
  
  // Display the guess on LCD
  void displayGuess(int* guess) {
-     clearLCD();
-     char guessStr[20];
-     sprintf(guessStr, "Guess: %d %d %d", guess[0], guess[1], guess[2]);
-     writeLineToLCD(guessStr, 0);
-     writeLineToLCD("Processing...", 1);
-     usleep(500000); // 0.5 second pause
+     dlPatchf(&dlScreens[SCREEN_GUESS], 0, "%d %d %d", guess[0], guess[1], guess[2]);
+     dlShow(&dlScreens[SCREEN_GUESS]);
+     clockSleepUs(500000); // 0.5 second pause
  }
  
  // Display answer via LEDs and LCD
  void displayAnswer(int exactMatches, int approxMatches) {
-     // Display on LEDs
-     blinkLED(GREEN_LED, exactMatches);  // Exact matches
-     blinkLED(RED_LED, 1);               // Separator
-     blinkLED(GREEN_LED, approxMatches); // Approximate matches
+     // Display on LEDs, in the encoding chosen with -L
+     uint64_t ledStart = clockNowNs();
+     ledShowScore(exactMatches, approxMatches, CODE_LENGTH);
+     uint64_t ledNs = clockNowNs() - ledStart;
      
      // Display on LCD
-     clearLCD();
-     char answerStr[20];
-     sprintf(answerStr, "Exact: %d", exactMatches);
-     writeLineToLCD(answerStr, 0);
-     sprintf(answerStr, "Approx: %d", approxMatches);
-     writeLineToLCD(answerStr, 1);
+     dlPatchf(&dlScreens[SCREEN_ANSWER], 0, "%d", exactMatches);
+     dlPatchf(&dlScreens[SCREEN_ANSWER], 1, "%d", approxMatches);
+     dlShow(&dlScreens[SCREEN_ANSWER]);
      
      if (verboseMode) {
          printf("Results: Exact matches = %d, Approximate matches = %d\n", 
                 exactMatches, approxMatches);
+         printf("LED feedback: %llu ms\n", (unsigned long long)(ledNs / 1000000));
      }
      
      // Pause to let user see the result
-     sleep(2);
+     clockSleepMs(2000);
  }
  
  // Display success message
@@ -392,27 +700,21 @@
      digitalWrite(RED_LED, 0); // Turn off red LED
      
      // Display on LCD
-     clearLCD();
-     writeLineToLCD("SUCCESS!", 0);
-     char attemptsStr[20];
-     sprintf(attemptsStr, "Attempts: %d", attempts);
-     writeLineToLCD(attemptsStr, 1);
+     dlPatchf(&dlScreens[SCREEN_SUCCESS], 0, "%d", attempts);
+     dlShow(&dlScreens[SCREEN_SUCCESS]);
      
      if (verboseMode) {
          printf("Game won in %d attempts!\n", attempts);
      }
      
      // Keep success message displayed
-     sleep(5);
+     clockSleepMs(5000);
  }
  
  // Display game over message
  void displayGameOver(int* secret) {
-     clearLCD();
-     writeLineToLCD("GAME OVER", 0);
-     char secretStr[20];
-     sprintf(secretStr, "Secret: %d %d %d", secret[0], secret[1], secret[2]);
-     writeLineToLCD(secretStr, 1);
+     dlPatchf(&dlScreens[SCREEN_GAME_OVER], 0, "%d %d %d", secret[0], secret[1], secret[2]);
+     dlShow(&dlScreens[SCREEN_GAME_OVER]);
      
      // Blink red LED 5 times to indicate game over
      blinkLED(RED_LED, 5);
@@ -423,13 +725,212 @@
      }
      
      // Keep game over message displayed
-     sleep(5);
+     clockSleepMs(5000);
+ }
+ 
+ // One game against count secrets at once; every guess is scored against all
+ // of them in one multiScore call. Returns 1 if every secret was found
+ int playMultiGame(int count) {
+     int secrets[MULTI_MAX * CODE_LENGTH], solved[MULTI_MAX] = {0};
+     int guess[CODE_LENGTH];
+     int numSolved = 0, attempts = 0, maxAttempts = MAX_ATTEMPTS + count;
+     uint8_t exact[MULTI_LANES], approx[MULTI_LANES];
+     MultiSecrets multi;
+     
+     rngSecrets(&gameRng, secrets, count, CODE_LENGTH, NUM_COLORS);
+     if (!multiLoad(&multi, secrets, count, CODE_LENGTH, NUM_COLORS)) return 0;
+     if (debugMode) {
+         for (int j = 0; j < count; j++) {
+             printf("Secret %d: %d %d %d\n", j + 1, secrets[j * CODE_LENGTH],
+                    secrets[j * CODE_LENGTH + 1], secrets[j * CODE_LENGTH + 2]);
+         }
+     }
+     
+     while (numSolved < count && attempts < maxAttempts) {
+         attempts++;
+         shmSetAttempt(attempts);
+         dlPatchf(&dlScreens[SCREEN_ATTEMPT], 0, "%d/%d", attempts, maxAttempts);
+         dlShow(&dlScreens[SCREEN_ATTEMPT]);
+         
+         getUserGuess(guess);
+         displayGuess(guess);
+         
+         PerfMark perf;
+         PERF_BEGIN(&perf);
+         multiScore(&multi, guess, exact, approx);
+         PERF_END(&perf, PERF_MATCH_GAME);
+         
+         // One character per secret: '*' once found, else its score glyph
+         // (or '-' for no match); the LEDs show the best open score
+         char summary[MULTI_MAX + 1];
+         int bestExact = -1, bestApprox = 0;
+         for (int j = 0; j < count; j++) {
+             if (!solved[j] && exact[j] == CODE_LENGTH) {
+                 solved[j] = 1;
+                 numSolved++;
+             }
+             if (solved[j]) {
+                 summary[j] = '*';
+                 continue;
+             }
+             summary[j] = scoreGlyph[exact[j]][approx[j]] ? scoreGlyph[exact[j]][approx[j]] : '-';
+             if (exact[j] > bestExact || (exact[j] == bestExact && approx[j] > bestApprox)) {
+                 bestExact = exact[j];
+                 bestApprox = approx[j];
+             }
+         }
+         summary[count] = '\0';
+         shmSetScore(bestExact < 0 ? CODE_LENGTH : bestExact, bestApprox);
+         
+         ledShowScore(bestExact < 0 ? CODE_LENGTH : bestExact, bestApprox, CODE_LENGTH);
+         dlPatchf(&dlScreens[SCREEN_MULTI], 0, "%d/%d", numSolved, count);
+         dlPatch(&dlScreens[SCREEN_MULTI], 1, summary);
+         dlShow(&dlScreens[SCREEN_MULTI]);
+         
+         if (verboseMode) {
+             printf("Scores:");
+             for (int j = 0; j < count; j++) {
+                 printf(" %d/%d%s", exact[j], approx[j], solved[j] ? "*" : "");
+             }
+             printf(" (%d of %d solved)\n", numSolved, count);
+         }
+         clockSleepMs(2000);
+         
+         if (numSolved < count) {
+             signalNextRound();
+         }
+     }
+     
+     if (numSolved == count) {
+         shmSetPhase(SHM_PHASE_WON);
+         displaySuccess(attempts);
+         return 1;
+     }
+     
+     shmSetPhase(SHM_PHASE_LOST);
+     dlPatchf(&dlScreens[SCREEN_MULTI_OVER], 0, "%d/%d", numSolved, count);
+     dlShow(&dlScreens[SCREEN_MULTI_OVER]);
+     blinkLED(RED_LED, 5);
+     if (verboseMode) {
+         printf("Game over! Solved %d of %d secrets\n", numSolved, count);
+     }
+     clockSleepMs(5000);
+     return 0;
  }
  
  // Signal the start of the next round
  void signalNextRound(void) {
-     // Blink red LED 3 times to indicate next round
-     blinkLED(RED_LED, 3);
+     // Red LED: 3 blinks, a fade or 3 pulses, depending on the LED mode
+     ledSignalNextRound();
+ }
+ 
+ // Build one CGRAM glyph per possible score: exact pegs as tall dots on top,
+ // approximate pegs as short dots underneath. (0,0) stays a plain '-'.
+ void initHistoryGlyphs(void) {
+     static const unsigned char pegBits[3] = {0x10, 0x04, 0x01};
+     int slot = 0;
+     
+     memset(scoreGlyph, 0, sizeof(scoreGlyph));
+     for (int e = 0; e <= CODE_LENGTH; e++) {
+         for (int a = 0; a + e <= CODE_LENGTH; a++) {
+             // Nothing to draw, or a score no guess can produce
+             if ((e == 0 && a == 0) || (e == CODE_LENGTH - 1 && a == 1)) continue;
+             if (slot == 8) return; // Out of CGRAM slots
+             
+             unsigned char rows[8] = {0};
+             for (int i = 0; i < e; i++) {
+                 rows[1] |= pegBits[i];
+                 rows[2] |= pegBits[i];
+             }
+             for (int i = 0; i < a; i++) {
+                 rows[5] |= pegBits[i];
+             }
+             defineCharLCD(slot, rows);
+             scoreGlyph[e][a] = 8 + slot; // Codes 8-15 mirror CGRAM 0-7
+             slot++;
+         }
+     }
+ }
+ 
+ // Remember a guess and its score for the history view
+ void recordHistory(int* guess, int exactMatches, int approxMatches) {
+     if (historyCount >= MAX_ATTEMPTS) return;
+     memcpy(historyGuess[historyCount], guess, sizeof(historyGuess[0]));
+     historyExact[historyCount] = exactMatches;
+     historyApprox[historyCount] = approxMatches;
+     historyCount++;
+ }
+ 
+ // Show every past guess side by side in DDRAM and scroll through them with
+ // the display-shift instruction: one bus transaction per column.
+ // Tap = one entry further back (wrapping to the latest), hold = leave.
+ void browseHistory(void) {
+     int maxOffset = historyCount * HISTORY_COLS - LCD_VISIBLE_COLS;
+     int offset = 0; // Leftmost visible DDRAM column
+     int idle = 0;
+     
+     if (maxOffset < 0) maxOffset = 0;
+     
+     pthread_mutex_lock(&lcd_mutex);
+     clearLCD(); // Also resets any display shift
+     for (int h = 0; h < historyCount; h++) {
+         char label[8];
+         setCursorLCD(0, h * HISTORY_COLS);
+         for (int i = 0; i < CODE_LENGTH; i++) {
+             writeCharLCD('0' + historyGuess[h][i]);
+         }
+         unsigned char glyph = scoreGlyph[historyExact[h]][historyApprox[h]];
+         writeCharLCD(glyph ? glyph : '-');
+         
+         sprintf(label, "#%d", h + 1);
+         setCursorLCD(1, h * HISTORY_COLS);
+         writeStringToLCD(label);
+     }
+     
+     // Start with the latest guesses in view
+     while (offset < maxOffset) {
+         shiftDisplayLCD(0);
+         offset++;
+     }
+     pthread_mutex_unlock(&lcd_mutex);
+     
+     while (idle < HISTORY_IDLE_MS) {
+         if (!readButton()) {
+             clockSleepUs(10000); // 10ms delay
+             idle += 10;
+             continue;
+         }
+         
+         // Measure how long the button is held
+         int held = 0;
+         while (readButton()) {
+             clockSleepUs(10000); // 10ms delay
+             held += 10;
+         }
+         clockSleepUs(50000); // Debounce
+         if (held >= HISTORY_HOLD_MS) break;
+         
+         // Tap: one entry back, or wrap around to the latest
+         pthread_mutex_lock(&lcd_mutex);
+         if (offset == 0) {
+             while (offset < maxOffset) {
+                 shiftDisplayLCD(0);
+                 offset++;
+             }
+         } else {
+             for (int i = 0; i < HISTORY_COLS && offset > 0; i++) {
+                 shiftDisplayLCD(1);
+                 offset--;
+             }
+         }
+         pthread_mutex_unlock(&lcd_mutex);
+         idle = 0;
+     }
+     
+     // Undo the shift: a screen that keeps a line does not clear the LCD
+     pthread_mutex_lock(&lcd_mutex);
+     homeLCD();
+     pthread_mutex_unlock(&lcd_mutex);
  }
  
  // Unit test function
@@ -457,7 +958,10 @@
      }
      
      // Calculate matches using assembly function
+     PerfMark perf;
+     PERF_BEGIN(&perf);
      matchesASM(secret, guess, CODE_LENGTH, &exactMatches, &approxMatches);
+     PERF_END(&perf, PERF_MATCH_UNIT);
      
      // Display results
      printf("Unit Test Results:\n");
@@ -482,10 +986,8 @@
      writeLineToLCD(resultStr, 1);
      
      // Visual feedback with LEDs
-     blinkLED(GREEN_LED, exactMatches);
-     blinkLED(RED_LED, 1);
-     blinkLED(GREEN_LED, approxMatches);
+     ledShowScore(exactMatches, approxMatches, CODE_LENGTH);
      
      // Keep results displayed
-     sleep(5);
- }while (0);
\ No newline at end of file
+     clockSleepMs(5000);
+ }
@@ -0,0 +1,55 @@
+/*
+ * Allocation check for the test build: counts allocator calls during play
+ * For F28HS Coursework 2
+ *
+ * Linked into mastermind-alloc with -Wl,--wrap=malloc (and calloc, realloc,
+ * free), so every call the game's own code makes to the C allocator comes
+ * through here. Calls made while arenaNoMalloc is set are counted, and at
+ * exit any such call turns the exit status into a failure.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <unistd.h>
+ #include "mm-arena.h"
+
+ void* __real_malloc(size_t bytes);
+ void* __real_calloc(size_t count, size_t bytes);
+ void* __real_realloc(void* p, size_t bytes);
+ void __real_free(void* p);
+
+ // Global variables
+ static unsigned long playCalls = 0;
+
+ static void countCall(void) {
+     if (arenaNoMalloc) __atomic_fetch_add(&playCalls, 1, __ATOMIC_RELAXED);
+ }
+
+ void* __wrap_malloc(size_t bytes) {
+     countCall();
+     return __real_malloc(bytes);
+ }
+
+ void* __wrap_calloc(size_t count, size_t bytes) {
+     countCall();
+     return __real_calloc(count, bytes);
+ }
+
+ void* __wrap_realloc(void* p, size_t bytes) {
+     countCall();
+     return __real_realloc(p, bytes);
+ }
+
+ void __wrap_free(void* p) {
+     if (p != NULL) countCall();
+     __real_free(p);
+ }
+
+ static void allocReport(void) {
+     fprintf(stderr, "Allocation check: %lu allocator calls during play\n", playCalls);
+     if (playCalls != 0) _exit(1);
+ }
+
+ __attribute__((constructor)) static void allocCheckInit(void) {
+     atexit(allocReport);
+ }
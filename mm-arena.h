@@ -0,0 +1,48 @@
+/*
+ * Bump allocator for per-game and per-search state
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_ARENA_H
+ #define MM_ARENA_H
+
+ #include <stddef.h>
+
+ #define ARENA_ALIGN 16
+ #define ARENA_GAME_BYTES (1u << 20)    // Per-thread arena of the game (hint mode needs a few KB)
+
+ // One block, allocated from the bottom up and reset as a whole. Temporary
+ // scratch comes from the top down and is released to a mark, so it never
+ // strands the allocations made while it was live
+ typedef struct {
+     unsigned char* base;
+     size_t size;
+     size_t used;           // Bottom: allocations that live until arenaReset
+     size_t top;            // Top: scratch, base + top is its lowest byte
+     size_t peak;           // Most bytes in use (both ends) since arenaCreate
+     unsigned long failed;  // Requests that did not fit
+ } Arena;
+
+ // Set while the game is playing; the allocation-check build fails if
+ // malloc, calloc, realloc or free are called meanwhile
+ extern volatile int arenaNoMalloc;
+
+ // Function prototypes for arenas
+ int arenaCreate(Arena* a, size_t bytes);
+ void arenaDestroy(Arena* a);
+ void* arenaAlloc(Arena* a, size_t bytes);
+ void arenaReset(Arena* a);
+ void* arenaTemp(Arena* a, size_t bytes);
+ size_t arenaTempMark(const Arena* a);
+ void arenaTempRelease(Arena* a, size_t mark);
+
+ // Function prototypes for the calling thread's arena. With one bound,
+ // arenaMalloc/arenaCalloc allocate from it and arenaFree of its memory does
+ // nothing; without one (or once it is full) they are malloc, calloc and free
+ void arenaBind(Arena* a);
+ Arena* arenaThread(void);
+ void* arenaMalloc(size_t bytes);
+ void* arenaCalloc(size_t count, size_t bytes);
+ void arenaFree(void* p);
+
+ #endif // MM_ARENA_H
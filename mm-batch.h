@@ -0,0 +1,12 @@
+/*
+ * Hardware-free batch scoring mode
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_BATCH_H
+ #define MM_BATCH_H
+
+ // Function prototypes for batch mode
+ int runBatch(const char* path, int length, int colors);
+
+ #endif // MM_BATCH_H
@@ -0,0 +1,144 @@
+/*
+ * Clock for every delay in the game: real time, or virtual time for tests
+ * For F28HS Coursework 2
+ *
+ * In real time a sleep is a sleep. In virtual time nothing waits: the clock
+ * is a counter, and a sleep just records a deadline. When every counted
+ * thread is asleep the clock jumps to the earliest deadline and wakes the
+ * threads due then, so events keep the order and spacing they would have
+ * in real time (a 10 s input timeout still fires after exactly 10 s of
+ * button polling), but a whole game runs as fast as the CPU allows.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <time.h>
+ #include <pthread.h>
+ #include "mm-clock.h"
+
+ typedef struct Sleeper {
+     uint64_t deadline;
+     int woken;
+     struct Sleeper* next;
+ } Sleeper;
+
+ // Global variables
+ int clockVirtual = 0;
+ static pthread_mutex_t clockMutex = PTHREAD_MUTEX_INITIALIZER;
+ static pthread_cond_t clockWake = PTHREAD_COND_INITIALIZER;
+ static uint64_t virtualNs = 0;
+ static int running = 1;         // Counted threads not asleep, the caller of clockInit included
+ static Sleeper* sleepers = NULL;
+
+ // Choose real or virtual time, before any other thread uses the clock
+ void clockInit(int virtualTime) {
+     clockVirtual = virtualTime;
+     virtualNs = 0;
+     running = 1;
+ }
+
+ // Current time in nanoseconds (CLOCK_MONOTONIC, or since clockInit)
+ uint64_t clockNowNs(void) {
+     if (clockVirtual) {
+         pthread_mutex_lock(&clockMutex);
+         uint64_t now = virtualNs;
+         pthread_mutex_unlock(&clockMutex);
+         return now;
+     }
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+ }
+
+ // With everyone asleep, jump to the earliest deadline and wake whoever is
+ // due; the woken threads count as running at once, so the clock cannot
+ // move again before they have had their turn. Called with the mutex held
+ static void clockAdvance(void) {
+     uint64_t next = UINT64_MAX;
+     for (Sleeper* s = sleepers; s != NULL; s = s->next) {
+         if (!s->woken && s->deadline < next) next = s->deadline;
+     }
+     if (next == UINT64_MAX) return;
+     if (next > virtualNs) virtualNs = next;
+     for (Sleeper* s = sleepers; s != NULL; s = s->next) {
+         if (!s->woken && s->deadline <= virtualNs) {
+             s->woken = 1;
+             running++;
+         }
+     }
+     pthread_cond_broadcast(&clockWake);
+ }
+
+ static void sleeperRemove(Sleeper* me) {
+     for (Sleeper** p = &sleepers; *p != NULL; p = &(*p)->next) {
+         if (*p == me) {
+             *p = me->next;
+             break;
+         }
+     }
+ }
+
+ // Cancellation cleanup: the thread leaves the counted set for good
+ static void sleepCancelled(void* arg) {
+     Sleeper* me = arg;
+     sleeperRemove(me);
+     if (me->woken) running--;
+     if (running == 0) clockAdvance();
+     pthread_mutex_unlock(&clockMutex);
+ }
+
+ static void virtualSleep(uint64_t ns) {
+     Sleeper me;
+
+     pthread_mutex_lock(&clockMutex);
+     me.deadline = virtualNs + ns;
+     me.woken = 0;
+     me.next = sleepers;
+     sleepers = &me;
+     running--;
+     pthread_cleanup_push(sleepCancelled, &me);
+     if (running == 0) clockAdvance();
+     while (!me.woken) {
+         pthread_cond_wait(&clockWake, &clockMutex);
+     }
+     pthread_cleanup_pop(0);
+     sleeperRemove(&me);
+     pthread_mutex_unlock(&clockMutex);
+ }
+
+ void clockSleepUs(uint64_t us) {
+     if (clockVirtual) {
+         virtualSleep(us * 1000);
+         return;
+     }
+     struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+     clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, NULL);
+ }
+
+ void clockSleepMs(uint64_t ms) {
+     clockSleepUs(ms * 1000);
+ }
+
+ // Sleep until an absolute clockNowNs time, so periodic work does not drift
+ void clockSleepUntilNs(uint64_t deadline) {
+     if (clockVirtual) {
+         uint64_t now = clockNowNs();
+         if (deadline > now) virtualSleep(deadline - now);
+         return;
+     }
+     struct timespec ts = { deadline / 1000000000ull, deadline % 1000000000ull };
+     clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+ }
+
+ void clockThreadBegin(void) {
+     pthread_mutex_lock(&clockMutex);
+     running++;
+     pthread_mutex_unlock(&clockMutex);
+ }
+
+ void clockThreadEnd(void) {
+     pthread_mutex_lock(&clockMutex);
+     running--;
+     if (running == 0) clockAdvance();
+     pthread_mutex_unlock(&clockMutex);
+ }
@@ -0,0 +1,27 @@
+/*
+ * Clock for every delay in the game: real time, or virtual time for tests
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_CLOCK_H
+ #define MM_CLOCK_H
+
+ #include <stdint.h>
+
+ // Set by clockInit; virtual time only makes sense with the simulated backend
+ extern int clockVirtual;
+
+ // Function prototypes for the clock
+ void clockInit(int virtualTime);
+ uint64_t clockNowNs(void);
+ void clockSleepUs(uint64_t us);
+ void clockSleepMs(uint64_t ms);
+ void clockSleepUntilNs(uint64_t deadline);
+
+ // A thread that sleeps on the virtual clock must be counted: the parent
+ // calls clockThreadBegin before creating it, the thread clockThreadEnd when
+ // it is done (a thread cancelled while sleeping is taken off automatically)
+ void clockThreadBegin(void);
+ void clockThreadEnd(void);
+
+ #endif // MM_CLOCK_H
@@ -0,0 +1,620 @@
+/*
+ * Compressed candidate sets for big code spaces
+ * For F28HS Coursework 2
+ *
+ * A flat bitset over 8 pegs x 10 colours is 12.5 MB, too much to keep
+ * several of on the Pi. Here the code space is cut into 65536-code chunks
+ * (the Roaring layout) and each chunk is stored the cheapest of three ways:
+ * a sorted array of offsets for sparse chunks, a bitmap for dense ones, or
+ * a list of runs for long stretches. The full set is one run per chunk, and
+ * as guesses narrow the set the chunks fall back to small arrays, so memory
+ * follows the number of candidates rather than the size of the board.
+ *
+ * Sets are immutable: filtering, partitioning and intersection build new
+ * ones chunk by chunk through a scratch bitmap, then pick the encoding.
+ * Sets come from the thread's arena when it has one (mm-arena.c) and the
+ * scratch from its top end, so filtering during a game never calls malloc.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "mm-cset.h"
+ #include "mm-kernels.h"
+ #include "mm-arena.h"
+
+ #define CSET_WORDS ((int)(CSET_CHUNK_SIZE / 64))
+
+ extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
+
+ // Builds a set in increasing code order
+ typedef struct {
+     Cset* set;
+     uint32_t key;              // Chunk being filled
+     int open, failed;
+     uint64_t bits[CSET_WORDS];
+ } CsetBuilder;
+
+ Cset* csetCreate(int pegs, int colors) {
+     uint64_t codes = 1;
+     for (int i = 0; i < pegs; i++) {
+         codes *= colors;
+     }
+     if (pegs < 1 || pegs > CSET_MAX_PEGS || colors < 1 || codes > UINT32_MAX) {
+         fprintf(stderr, "Candidate set: %d pegs x %d colours is too big\n", pegs, colors);
+         return NULL;
+     }
+     Cset* s = arenaCalloc(1, sizeof(Cset));
+     if (s == NULL) return NULL;
+     s->pegs = pegs;
+     s->colors = colors;
+     s->codes = (uint32_t)codes;
+     return s;
+ }
+
+ void csetFree(Cset* s) {
+     if (s == NULL) return;
+     for (int i = 0; i < s->count; i++) {
+         arenaFree(s->chunks[i].data);
+     }
+     arenaFree(s->chunks);
+     arenaFree(s);
+ }
+
+ // Room for cap chunks. Sets are sized up front where the count is known,
+ // since in an arena the array left behind by growing is not reused
+ static int chunkReserve(Cset* s, int cap) {
+     if (cap <= s->cap) return 1;
+     CsetChunk* c = arenaMalloc(sizeof(CsetChunk) * cap);
+     if (c == NULL) return 0;
+     if (s->count > 0) memcpy(c, s->chunks, sizeof(CsetChunk) * s->count);
+     arenaFree(s->chunks);
+     s->chunks = c;
+     s->cap = cap;
+     return 1;
+ }
+
+ static CsetChunk* chunkAppend(Cset* s) {
+     if (s->count == s->cap && !chunkReserve(s, s->cap ? s->cap * 2 : 16)) return NULL;
+     return &s->chunks[s->count++];
+ }
+
+ // Every code of the board: one run per chunk
+ Cset* csetFull(int pegs, int colors) {
+     Cset* s = csetCreate(pegs, colors);
+     if (s == NULL) return NULL;
+     if (!chunkReserve(s, (s->codes + CSET_CHUNK_SIZE - 1) / CSET_CHUNK_SIZE)) {
+         csetFree(s);
+         return NULL;
+     }
+
+     for (uint64_t base = 0; base < s->codes; base += CSET_CHUNK_SIZE) {
+         uint32_t len = s->codes - base < CSET_CHUNK_SIZE ? s->codes - base : CSET_CHUNK_SIZE;
+         CsetChunk* c = chunkAppend(s);
+         uint16_t* run = arenaMalloc(2 * sizeof(uint16_t));
+         if (c == NULL || run == NULL) {
+             arenaFree(run);
+             if (c != NULL) s->count--;
+             csetFree(s);
+             return NULL;
+         }
+         run[0] = 0;
+         run[1] = len - 1;
+         c->key = base >> CSET_CHUNK_BITS;
+         c->type = CSET_RUN;
+         c->card = len;
+         c->n = 1;
+         c->data = run;
+         s->card += len;
+     }
+     return s;
+ }
+
+ uint64_t csetCardinality(const Cset* s) {
+     return s->card;
+ }
+
+ static size_t chunkBytes(const CsetChunk* c) {
+     switch (c->type) {
+         case CSET_ARRAY: return c->n * sizeof(uint16_t);
+         case CSET_BITMAP: return CSET_WORDS * sizeof(uint64_t);
+         default: return c->n * 2 * sizeof(uint16_t);
+     }
+ }
+
+ // Heap bytes held by the set
+ size_t csetBytes(const Cset* s) {
+     size_t bytes = sizeof(Cset) + s->cap * sizeof(CsetChunk);
+     for (int i = 0; i < s->count; i++) {
+         bytes += chunkBytes(&s->chunks[i]);
+     }
+     return bytes;
+ }
+
+ static const CsetChunk* chunkFind(const Cset* s, uint32_t key) {
+     int lo = 0, hi = s->count - 1;
+     while (lo <= hi) {
+         int mid = (lo + hi) / 2;
+         if (s->chunks[mid].key == key) return &s->chunks[mid];
+         if (s->chunks[mid].key < key) {
+             lo = mid + 1;
+         } else {
+             hi = mid - 1;
+         }
+     }
+     return NULL;
+ }
+
+ int csetContains(const Cset* s, uint32_t code) {
+     const CsetChunk* c = chunkFind(s, code >> CSET_CHUNK_BITS);
+     uint16_t low = code & (CSET_CHUNK_SIZE - 1);
+     if (c == NULL) return 0;
+
+     if (c->type == CSET_BITMAP) {
+         return (((const uint64_t*)c->data)[low / 64] >> (low % 64)) & 1;
+     }
+     const uint16_t* v = c->data;
+     int lo = 0, hi = c->n - 1;
+     while (lo <= hi) {
+         int mid = (lo + hi) / 2;
+         uint16_t start = c->type == CSET_ARRAY ? v[mid] : v[2 * mid];
+         uint32_t end = c->type == CSET_ARRAY ? start : (uint32_t)start + v[2 * mid + 1];
+         if (low < start) {
+             hi = mid - 1;
+         } else if (low > end) {
+             lo = mid + 1;
+         } else {
+             return 1;
+         }
+     }
+     return 0;
+ }
+
+ // Expand a chunk into a bitmap
+ static void chunkToBits(const CsetChunk* c, uint64_t* bits) {
+     if (c->type == CSET_BITMAP) {
+         memcpy(bits, c->data, CSET_WORDS * sizeof(uint64_t));
+         return;
+     }
+     memset(bits, 0, CSET_WORDS * sizeof(uint64_t));
+     const uint16_t* v = c->data;
+     if (c->type == CSET_ARRAY) {
+         for (uint32_t i = 0; i < c->n; i++) {
+             bits[v[i] / 64] |= 1ull << (v[i] % 64);
+         }
+         return;
+     }
+     for (uint32_t i = 0; i < c->n; i++) {
+         uint32_t start = v[2 * i], end = start + v[2 * i + 1];
+         for (uint32_t w = start / 64; w <= end / 64; w++) {
+             uint32_t lo = w * 64 > start ? 0 : start % 64;
+             uint32_t hi = w * 64 + 63 < end ? 63 : end % 64;
+             uint64_t mask = (hi == 63 ? ~0ull : (1ull << (hi + 1)) - 1) & ~((1ull << lo) - 1);
+             bits[w] |= mask;
+         }
+     }
+ }
+
+ // Encode a bitmap as the smallest container and append it as chunk key
+ static int chunkFromBits(Cset* s, uint32_t key, const uint64_t* bits) {
+     uint32_t card = 0, runs = 0;
+     uint64_t carry = 0;
+     for (int w = 0; w < CSET_WORDS; w++) {
+         card += __builtin_popcountll(bits[w]);
+         runs += __builtin_popcountll(bits[w] & ~(bits[w] << 1 | carry));
+         carry = bits[w] >> 63;
+     }
+     if (card == 0) return 1;
+
+     size_t arrayBytes = card <= CSET_ARRAY_MAX ? card * sizeof(uint16_t) : SIZE_MAX;
+     size_t runBytes = runs * 2 * sizeof(uint16_t);
+     size_t bitmapBytes = CSET_WORDS * sizeof(uint64_t);
+     CsetChunk* c = chunkAppend(s);
+     if (c == NULL) return 0;
+     c->key = key;
+     c->card = card;
+
+     if (runBytes <= arrayBytes && runBytes < bitmapBytes) {
+         uint16_t* v = arenaMalloc(runBytes);
+         if (v == NULL) goto fail;
+         uint32_t n = 0;
+         for (uint32_t i = 0; i < CSET_CHUNK_SIZE; ) {
+             if (!((bits[i / 64] >> (i % 64)) & 1)) {
+                 // Skip whole empty words
+                 if (i % 64 == 0 && bits[i / 64] == 0) {
+                     i += 64;
+                 } else {
+                     i++;
+                 }
+                 continue;
+             }
+             uint32_t start = i;
+             while (i < CSET_CHUNK_SIZE && ((bits[i / 64] >> (i % 64)) & 1)) {
+                 i += (i % 64 == 0 && bits[i / 64] == ~0ull) ? 64 : 1;
+             }
+             v[2 * n] = start;
+             v[2 * n + 1] = i - start - 1;
+             n++;
+         }
+         c->type = CSET_RUN;
+         c->n = n;
+         c->data = v;
+     } else if (arrayBytes < bitmapBytes) {
+         uint16_t* v = arenaMalloc(arrayBytes);
+         if (v == NULL) goto fail;
+         uint32_t n = 0;
+         for (int w = 0; w < CSET_WORDS; w++) {
+             for (uint64_t b = bits[w]; b != 0; b &= b - 1) {
+                 v[n++] = w * 64 + __builtin_ctzll(b);
+             }
+         }
+         c->type = CSET_ARRAY;
+         c->n = n;
+         c->data = v;
+     } else {
+         uint64_t* v = arenaMalloc(bitmapBytes);
+         if (v == NULL) goto fail;
+         memcpy(v, bits, bitmapBytes);
+         c->type = CSET_BITMAP;
+         c->n = 0;
+         c->data = v;
+     }
+     s->card += card;
+     return 1;
+
+ fail:
+     s->count--;
+     return 0;
+ }
+
+ // Zeroed scratch from the top of the thread's arena, or from calloc when
+ // there is none or it is full. Give it back with arenaFree, then release
+ // the arena part to the mark taken before
+ static void* scratchAlloc(size_t bytes) {
+     Arena* a = arenaThread();
+     void* p = a != NULL ? arenaTemp(a, bytes) : NULL;
+     if (p == NULL) return calloc(1, bytes);
+     memset(p, 0, bytes);
+     return p;
+ }
+
+ static size_t scratchMark(void) {
+     Arena* a = arenaThread();
+     return a != NULL ? arenaTempMark(a) : 0;
+ }
+
+ static void scratchRelease(size_t mark) {
+     Arena* a = arenaThread();
+     if (a != NULL) arenaTempRelease(a, mark);
+ }
+
+ static void builderAdd(CsetBuilder* b, uint32_t code) {
+     uint32_t key = code >> CSET_CHUNK_BITS;
+     if (!b->open || key != b->key) {
+         if (b->open && !chunkFromBits(b->set, b->key, b->bits)) b->failed = 1;
+         memset(b->bits, 0, sizeof(b->bits));
+         b->key = key;
+         b->open = 1;
+     }
+     uint32_t low = code & (CSET_CHUNK_SIZE - 1);
+     b->bits[low / 64] |= 1ull << (low % 64);
+ }
+
+ // Close the builder; returns its set, or NULL if an allocation failed
+ static Cset* builderFinish(CsetBuilder* b) {
+     if (b->open && !chunkFromBits(b->set, b->key, b->bits)) b->failed = 1;
+     if (b->failed) {
+         fprintf(stderr, "Candidate set: out of memory\n");
+         csetFree(b->set);
+         return NULL;
+     }
+     return b->set;
+ }
+
+ void csetIterInit(CsetIter* it, const Cset* s) {
+     it->set = s;
+     it->chunk = 0;
+     it->i = it->j = 0;
+     it->word = s->count > 0 && s->chunks[0].type == CSET_BITMAP ? ((uint64_t*)s->chunks[0].data)[0] : 0;
+ }
+
+ // Next code of the set, returns 0 when there are no more
+ int csetIterNext(CsetIter* it, uint32_t* code) {
+     while (it->chunk < it->set->count) {
+         const CsetChunk* c = &it->set->chunks[it->chunk];
+         uint32_t base = c->key << CSET_CHUNK_BITS;
+
+         if (c->type == CSET_ARRAY) {
+             if (it->i < c->n) {
+                 *code = base + ((uint16_t*)c->data)[it->i++];
+                 return 1;
+             }
+         } else if (c->type == CSET_RUN) {
+             const uint16_t* v = c->data;
+             if (it->i < c->n) {
+                 *code = base + v[2 * it->i] + it->j;
+                 if (it->j++ == v[2 * it->i + 1]) {
+                     it->i++;
+                     it->j = 0;
+                 }
+                 return 1;
+             }
+         } else {
+             const uint64_t* v = c->data;
+             while (it->word == 0 && ++it->i < CSET_WORDS) {
+                 it->word = v[it->i];
+             }
+             if (it->i < CSET_WORDS) {
+                 *code = base + it->i * 64 + __builtin_ctzll(it->word);
+                 it->word &= it->word - 1;
+                 return 1;
+             }
+         }
+
+         // Next chunk
+         it->chunk++;
+         it->i = it->j = 0;
+         it->word = 0;
+         if (it->chunk < it->set->count && it->set->chunks[it->chunk].type == CSET_BITMAP) {
+             it->word = ((uint64_t*)it->set->chunks[it->chunk].data)[0];
+         }
+     }
+     return 0;
+ }
+
+ // Pegs (colours 1..colors) of a code index
+ void csetDecode(const Cset* s, uint32_t code, int* pegs) {
+     for (int i = s->pegs - 1; i >= 0; i--) {
+         pegs[i] = code % s->colors + 1;
+         code /= s->colors;
+     }
+ }
+
+ uint32_t csetEncode(const Cset* s, const int* pegs) {
+     uint32_t code = 0;
+     for (int i = 0; i < s->pegs; i++) {
+         code = code * s->colors + (pegs[i] - 1);
+     }
+     return code;
+ }
+
+ // Walks a set in order, keeping the pegs of the current code; consecutive
+ // codes (the common case) cost one odometer step instead of a decode
+ typedef struct {
+     CsetIter it;
+     uint32_t code;
+     int pegs[CSET_MAX_PEGS];
+ } CsetWalk;
+
+ static void walkInit(CsetWalk* w, const Cset* s) {
+     csetIterInit(&w->it, s);
+     w->code = UINT32_MAX;
+ }
+
+ static int walkNext(CsetWalk* w) {
+     const Cset* s = w->it.set;
+     uint32_t next;
+     if (!csetIterNext(&w->it, &next)) return 0;
+     if (next == w->code + 1 && w->code != UINT32_MAX) {
+         for (int i = s->pegs - 1; i >= 0 && ++w->pegs[i] > s->colors; i--) {
+             w->pegs[i] = 1;
+         }
+     } else {
+         csetDecode(s, next, w->pegs);
+     }
+     w->code = next;
+     return 1;
+ }
+
+ static void scoreCode(const Cset* s, MatchKernel kernel, int* code, const int* guess, int* exact, int* approx) {
+     if (kernel != NULL) {
+         kernel(code, guess, exact, approx);
+     } else {
+         matchesASM(code, (int*)guess, s->pegs, exact, approx);
+     }
+ }
+
+ // Candidates that would give guess the score (exact, approx)
+ Cset* csetFilter(const Cset* s, const int* guess, int exact, int approx) {
+     size_t mark = scratchMark();
+     CsetBuilder* b = scratchAlloc(sizeof(CsetBuilder));
+     if (b == NULL) return NULL;
+     b->set = csetCreate(s->pegs, s->colors);
+     if (b->set == NULL || !chunkReserve(b->set, s->count)) {
+         csetFree(b->set);
+         arenaFree(b);
+         scratchRelease(mark);
+         return NULL;
+     }
+
+     MatchKernel kernel = findKernel(s->pegs, s->colors);
+     CsetWalk w;
+     walkInit(&w, s);
+     while (walkNext(&w)) {
+         int e, a;
+         scoreCode(s, kernel, w.pegs, guess, &e, &a);
+         if (e == exact && a == approx) builderAdd(b, w.code);
+     }
+     Cset* out = builderFinish(b);
+     arenaFree(b);
+     scratchRelease(mark);
+     return out;
+ }
+
+ // Split a set by the score each candidate gives guess, in one pass.
+ // parts[exact * (pegs + 1) + approx] gets each part (NULL if empty);
+ // returns the number of non-empty parts, or -1 if out of memory
+ int csetPartition(const Cset* s, const int* guess, Cset** parts) {
+     int scores = (s->pegs + 1) * (s->pegs + 1);
+     CsetBuilder* b[CSET_MAX_SCORES] = { NULL };
+     int nonEmpty = 0, failed = 0;
+     size_t mark = scratchMark();
+
+     MatchKernel kernel = findKernel(s->pegs, s->colors);
+     CsetWalk w;
+     walkInit(&w, s);
+     while (walkNext(&w) && !failed) {
+         int e, a;
+         scoreCode(s, kernel, w.pegs, guess, &e, &a);
+         int k = e * (s->pegs + 1) + a;
+         if (b[k] == NULL) {
+             // Builders are 8 KB each, only made for scores that occur
+             b[k] = scratchAlloc(sizeof(CsetBuilder));
+             if (b[k] == NULL || (b[k]->set = csetCreate(s->pegs, s->colors)) == NULL) {
+                 failed = 1;
+                 break;
+             }
+         }
+         builderAdd(b[k], w.code);
+     }
+
+     for (int k = 0; k < scores; k++) {
+         parts[k] = NULL;
+         if (b[k] == NULL) continue;
+         if (failed) {
+             csetFree(b[k]->set);
+         } else {
+             parts[k] = builderFinish(b[k]);
+             if (parts[k] == NULL) failed = 1;
+             else nonEmpty++;
+         }
+         arenaFree(b[k]);
+     }
+     scratchRelease(mark);
+     if (failed) {
+         for (int k = 0; k < scores; k++) {
+             csetFree(parts[k]);
+             parts[k] = NULL;
+         }
+         return -1;
+     }
+     return nonEmpty;
+ }
+
+ // Codes in both sets (same board)
+ Cset* csetAnd(const Cset* a, const Cset* b) {
+     size_t mark = scratchMark();
+     Cset* out = csetCreate(a->pegs, a->colors);
+     uint64_t* x = scratchAlloc(2 * CSET_WORDS * sizeof(uint64_t));
+     if (out == NULL || x == NULL || !chunkReserve(out, a->count < b->count ? a->count : b->count)) {
+         csetFree(out);
+         arenaFree(x);
+         scratchRelease(mark);
+         return NULL;
+     }
+     uint64_t* y = x + CSET_WORDS;
+
+     int i = 0, j = 0;
+     while (i < a->count && j < b->count) {
+         const CsetChunk* ca = &a->chunks[i];
+         const CsetChunk* cb = &b->chunks[j];
+         if (ca->key < cb->key) {
+             i++;
+         } else if (cb->key < ca->key) {
+             j++;
+         } else {
+             chunkToBits(ca, x);
+             chunkToBits(cb, y);
+             for (int w = 0; w < CSET_WORDS; w++) {
+                 x[w] &= y[w];
+             }
+             if (!chunkFromBits(out, ca->key, x)) {
+                 csetFree(out);
+                 arenaFree(x);
+                 scratchRelease(mark);
+                 return NULL;
+             }
+             i++;
+             j++;
+         }
+     }
+     arenaFree(x);
+     scratchRelease(mark);
+     return out;
+ }
+
+ static uint64_t hashMix(uint64_t h, uint64_t v) {
+     h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+     h ^= h >> 31;
+     h *= 0xbf58476d1ce4e5b9ull;
+     return h ^ (h >> 29);
+ }
+
+ // Hash of the board and the codes in the set. Encodings are chosen from
+ // the contents alone, so equal sets have equal chunks and hash the same
+ uint64_t csetHash(const Cset* s) {
+     uint64_t h = hashMix(s->pegs, s->colors);
+     for (int i = 0; i < s->count; i++) {
+         const CsetChunk* c = &s->chunks[i];
+         h = hashMix(h, (uint64_t)c->key << 32 | c->type);
+         h = hashMix(h, (uint64_t)c->card << 32 | c->n);
+         const uint16_t* v = c->data;
+         size_t n = chunkBytes(c) / sizeof(uint16_t);
+         for (size_t k = 0; k + 4 <= n; k += 4) {
+             h = hashMix(h, (uint64_t)v[k] | (uint64_t)v[k + 1] << 16 |
+                            (uint64_t)v[k + 2] << 32 | (uint64_t)v[k + 3] << 48);
+         }
+         for (size_t k = n & ~(size_t)3; k < n; k++) {
+             h = hashMix(h, v[k]);
+         }
+     }
+     return h;
+ }
+
+ // Worst case over the scores of guess: the most candidates that can be
+ // left (a win leaves none)
+ static uint64_t worstCase(const Cset* s, MatchKernel kernel, int* guess) {
+     uint64_t counts[CSET_MAX_SCORES] = { 0 }, worst = 0;
+     CsetWalk w;
+     walkInit(&w, s);
+     while (walkNext(&w)) {
+         int e, a;
+         scoreCode(s, kernel, w.pegs, guess, &e, &a);
+         if (e < s->pegs) counts[e * (s->pegs + 1) + a]++;
+     }
+     for (int k = 0; k < CSET_MAX_SCORES; k++) {
+         if (counts[k] > worst) worst = counts[k];
+     }
+     return worst;
+ }
+
+ // Guess that leaves the fewest candidates in the worst case (Knuth's
+ // minimax). Every code of the board is tried when that fits in
+ // CSET_GUESS_WORK scorings, otherwise as many candidates as fit (at least
+ // one). Ties go to candidates, which may win outright. Returns 0 if the
+ // set is empty
+ int csetBestGuess(const Cset* s, int* guess, uint64_t* bound) {
+     if (s->card == 0) return 0;
+     MatchKernel kernel = findKernel(s->pegs, s->colors);
+     uint64_t best = UINT64_MAX;
+     int bestIn = 0;
+
+     if ((uint64_t)s->codes * s->card <= CSET_GUESS_WORK) {
+         int pegs[CSET_MAX_PEGS];
+         for (uint32_t code = 0; code < s->codes; code++) {
+             csetDecode(s, code, pegs);
+             uint64_t worst = worstCase(s, kernel, pegs);
+             int in = csetContains(s, code);
+             if (worst < best || (worst == best && in && !bestIn)) {
+                 best = worst;
+                 bestIn = in;
+                 memcpy(guess, pegs, s->pegs * sizeof(int));
+             }
+         }
+         *bound = best;
+         return 1;
+     }
+
+     uint64_t pool = CSET_GUESS_WORK / s->card;
+     CsetWalk w;
+     walkInit(&w, s);
+     for (uint64_t i = 0; (i < pool || i == 0) && walkNext(&w); i++) {
+         uint64_t worst = worstCase(s, kernel, w.pegs);
+         if (worst < best) {
+             best = worst;
+             memcpy(guess, w.pegs, s->pegs * sizeof(int));
+         }
+     }
+     *bound = best;
+     return 1;
+ }
@@ -0,0 +1,70 @@
+/*
+ * Compressed candidate sets for big code spaces
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_CSET_H
+ #define MM_CSET_H
+
+ #include <stdint.h>
+ #include <stddef.h>
+
+ #define CSET_CHUNK_BITS 16
+ #define CSET_CHUNK_SIZE (1u << CSET_CHUNK_BITS)
+ #define CSET_ARRAY_MAX 4096            // Larger arrays are never smaller than a bitmap
+ #define CSET_MAX_PEGS 8
+ #define CSET_MAX_SCORES ((CSET_MAX_PEGS + 1) * (CSET_MAX_PEGS + 1))
+ #define CSET_GUESS_WORK (1u << 22)     // Scorings csetBestGuess may spend
+
+ // Container encodings, chosen per chunk for the smallest size
+ typedef enum {
+     CSET_ARRAY = 0,    // Sorted 16-bit offsets
+     CSET_BITMAP,       // 65536 bits
+     CSET_RUN           // (start, length - 1) pairs of 16-bit offsets
+ } CsetType;
+
+ // The codes of one 65536-code slice of the code space
+ typedef struct {
+     uint32_t key;          // code >> CSET_CHUNK_BITS
+     uint32_t type;
+     uint32_t card;         // Codes in the chunk
+     uint32_t n;            // Array entries or runs
+     void* data;
+ } CsetChunk;
+
+ // A set of codes (indices as in codeIndex: first peg most significant)
+ typedef struct {
+     int pegs, colors;
+     uint32_t codes;        // Size of the code space
+     uint64_t card;
+     int count, cap;        // Chunks, in key order
+     CsetChunk* chunks;
+ } Cset;
+
+ typedef struct {
+     const Cset* set;
+     int chunk;
+     uint32_t i, j;
+     uint64_t word;
+ } CsetIter;
+
+ // Function prototypes for candidate sets
+ Cset* csetCreate(int pegs, int colors);
+ Cset* csetFull(int pegs, int colors);
+ void csetFree(Cset* s);
+ uint64_t csetCardinality(const Cset* s);
+ size_t csetBytes(const Cset* s);
+ int csetContains(const Cset* s, uint32_t code);
+ Cset* csetAnd(const Cset* a, const Cset* b);
+ Cset* csetFilter(const Cset* s, const int* guess, int exact, int approx);
+ int csetPartition(const Cset* s, const int* guess, Cset** parts);
+ uint64_t csetHash(const Cset* s);
+ int csetBestGuess(const Cset* s, int* guess, uint64_t* bound);
+ void csetDecode(const Cset* s, uint32_t code, int* pegs);
+ uint32_t csetEncode(const Cset* s, const int* pegs);
+
+ // Function prototypes for iteration, in increasing code order
+ void csetIterInit(CsetIter* it, const Cset* s);
+ int csetIterNext(CsetIter* it, uint32_t* code);
+
+ #endif // MM_CSET_H
@@ -0,0 +1,254 @@
+/*
+  Generator for the LCD display lists of the static screens
+
+$ gcc -o mm-dlgen mm-dlgen.c
+$ ./mm-dlgen mm-screens.txt
+
+  Writes mm-dlists.c (one display list per screen plus the table
+  dlScreens) and mm-dlists.h (the SCREEN_ names) for the screens in
+  mm-screens.txt. Run from the Makefile, so the lists are regenerated
+  whenever a screen or the LCD wiring in lcdBinary.h changes.
+
+  A list is the whole bus waveform of the screen: every LCD byte as six
+  steps (high nibble on D7-D4 with RS, EN up, EN down, low nibble, EN up,
+  EN down), each one GPSET0 mask, one GPCLR0 mask and the minimum time to
+  hold before the next step. dlReplay in mm-dlist.c plays it back; slots
+  keep the step of their first byte, so dlPatch rewrites only their
+  nibble steps.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "lcdBinary.h"
+#include "mm-dlist.h"
+
+#define MAX_SCREENS 64
+#define MAX_SLOTS 8
+#define NAME_LEN 32
+
+typedef struct {
+  char name[NAME_LEN];
+  int lines;                          // Bit 0: line 0 given, bit 1: line 1
+  char text[2][DL_LINE_MAX + 1];      // Slots as spaces
+  DlSlot slots[MAX_SLOTS];
+  int numSlots;
+} Screen;
+
+static Screen screens[MAX_SCREENS];
+static int numScreens = 0;
+
+static const unsigned dataMask = (1u << LCD_RS) | (1u << LCD_D4) | (1u << LCD_D5) | (1u << LCD_D6) | (1u << LCD_D7);
+
+static unsigned nibbleBits (unsigned nibble, int rs) {
+  return (rs ? 1u << LCD_RS : 0) | (nibble & 1 ? 1u << LCD_D4 : 0) | (nibble & 2 ? 1u << LCD_D5 : 0) |
+         (nibble & 4 ? 1u << LCD_D6 : 0) | (nibble & 8 ? 1u << LCD_D7 : 0);
+}
+
+// Parse one "<text>" or - into a line of sc, slots {N} become N spaces
+static int parseLine (const char **p, Screen *sc, int line, const char *file, int lineNo) {
+  const char *s = *p;
+  while (isspace((unsigned char)*s))
+    s++;
+  if (*s == '-') {
+    *p = s + 1;
+    return 1;
+  }
+  if (*s++ != '"') {
+    fprintf(stderr, "%s:%d: expected \"<text>\" or -\n", file, lineNo);
+    return 0;
+  }
+
+  int col = 0;
+  while (*s != '"') {
+    if (*s == '\0' || *s == '\n') {
+      fprintf(stderr, "%s:%d: unterminated text\n", file, lineNo);
+      return 0;
+    }
+    int width = 1;
+    if (*s == '{') {
+      char *end;
+      width = strtol(s + 1, &end, 10);
+      if (*end != '}' || width < 1 || width > DL_LINE_MAX || sc->numSlots == MAX_SLOTS) {
+        fprintf(stderr, "%s:%d: bad slot (want {N}, at most %d per screen)\n", file, lineNo, MAX_SLOTS);
+        return 0;
+      }
+      sc->slots[sc->numSlots++] = (DlSlot){ 0, line, col, width };
+      s = end;
+    }
+    if (col + width > DL_LINE_MAX) {
+      fprintf(stderr, "%s:%d: line longer than %d characters\n", file, lineNo, DL_LINE_MAX);
+      return 0;
+    }
+    memset(sc->text[line] + col, *s == '}' ? ' ' : *s, width);
+    col += width;
+    s++;
+  }
+  sc->text[line][col] = '\0';
+  sc->lines |= 1 << line;
+  *p = s + 1;
+  return 1;
+}
+
+static int readScreens (const char *path) {
+  char buf[256];
+  int lineNo = 0;
+  FILE *in = fopen(path, "r");
+  if (in == NULL) {
+    perror(path);
+    return 0;
+  }
+
+  while (fgets(buf, sizeof(buf), in) != NULL) {
+    const char *p = buf;
+    lineNo++;
+    while (isspace((unsigned char)*p))
+      p++;
+    if (*p == '#' || *p == '\0')
+      continue;
+    if (numScreens == MAX_SCREENS) {
+      fprintf(stderr, "%s:%d: at most %d screens\n", path, lineNo, MAX_SCREENS);
+      fclose(in);
+      return 0;
+    }
+
+    Screen *sc = &screens[numScreens];
+    memset(sc, 0, sizeof(Screen));
+    int n = 0;
+    if (sscanf(p, "%31[A-Za-z0-9_]%n", sc->name, &n) != 1) {
+      fprintf(stderr, "%s:%d: expected a screen name\n", path, lineNo);
+      fclose(in);
+      return 0;
+    }
+    p += n;
+    if (!parseLine(&p, sc, 0, path, lineNo) || !parseLine(&p, sc, 1, path, lineNo)) {
+      fclose(in);
+      return 0;
+    }
+    numScreens++;
+  }
+  fclose(in);
+  return numScreens > 0;
+}
+
+// One LCD byte as six steps
+static void emitByte (FILE *out, unsigned char byte, int rs, const char *hold, const char *what) {
+  unsigned hi = nibbleBits(byte >> 4, rs), lo = nibbleBits(byte & 15, rs);
+  fprintf(out, "     // %s\n", what);
+  fprintf(out, "     { 0x%08x, 0x%08x, DL_SETUP_NS }, { 0x%08x, 0, DL_EN_NS }, { 0, 0x%08x, DL_EN_NS },\n",
+          hi, dataMask & ~hi, 1u << LCD_EN, 1u << LCD_EN);
+  fprintf(out, "     { 0x%08x, 0x%08x, DL_SETUP_NS }, { 0x%08x, 0, DL_EN_NS }, { 0, 0x%08x, %s },\n",
+          lo, dataMask & ~lo, 1u << LCD_EN, 1u << LCD_EN, hold);
+}
+
+// Screen name to its SCREEN_ constant: attemptHint -> SCREEN_ATTEMPT_HINT
+static void constName (char *buf, const char *name) {
+  buf += sprintf(buf, "SCREEN_");
+  for (const char *p = name; *p; p++) {
+    if (isupper((unsigned char)*p) && p != name)
+      *buf++ = '_';
+    *buf++ = toupper((unsigned char)*p);
+  }
+  *buf = '\0';
+}
+
+static void emitC (FILE *out, const char *src) {
+  fprintf(out, "/*\n * Generated by mm-dlgen from %s, do not edit\n * For F28HS Coursework 2\n */\n\n", src);
+  fprintf(out, " #include <stddef.h>\n #include \"mm-dlists.h\"\n\n");
+
+  for (int k = 0; k < numScreens; k++) {
+    Screen *sc = &screens[k];
+    int clear = sc->lines == 3, step = 0;
+    char what[DL_LINE_MAX + 16];
+
+    fprintf(out, " // %s\n", sc->name);
+    fprintf(out, " static DlStep steps_%s[] = {\n", sc->name);
+    if (clear) {
+      emitByte(out, 0x01, 0, "DL_CLEAR_NS", "Clear display");
+      step += DL_STEPS_PER_BYTE;
+    }
+    for (int line = 0; line < 2; line++) {
+      if (!(sc->lines & (1 << line)))
+        continue;
+      sprintf(what, "Cursor to line %d", line);
+      emitByte(out, 0x80 | (line ? 0x40 : 0x00), 0, "DL_EXEC_NS", what);
+      step += DL_STEPS_PER_BYTE;
+      for (int col = 0; sc->text[line][col]; col++) {
+        for (int s = 0; s < sc->numSlots; s++)
+          if (sc->slots[s].line == line && sc->slots[s].col == col)
+            sc->slots[s].step = step;
+        sprintf(what, "'%c'", sc->text[line][col]);
+        emitByte(out, sc->text[line][col], 1, "DL_EXEC_NS", what);
+        step += DL_STEPS_PER_BYTE;
+      }
+    }
+    fprintf(out, " };\n\n");
+
+    if (sc->numSlots > 0) {
+      fprintf(out, " static const DlSlot slots_%s[] = {", sc->name);
+      for (int s = 0; s < sc->numSlots; s++)
+        fprintf(out, "%s { %d, %d, %d, %d }", s ? "," : "", sc->slots[s].step, sc->slots[s].line,
+                sc->slots[s].col, sc->slots[s].width);
+      fprintf(out, " };\n\n");
+    }
+  }
+
+  fprintf(out, " // Indexed by the SCREEN_ constants\n");
+  fprintf(out, " DisplayList dlScreens[NUM_SCREENS] = {\n");
+  for (int k = 0; k < numScreens; k++) {
+    Screen *sc = &screens[k];
+    int bytes = (sc->lines == 3) + !!(sc->lines & 1) + !!(sc->lines & 2) +
+                (int)strlen(sc->text[0]) + (int)strlen(sc->text[1]);
+    fprintf(out, "     { \"%s\", steps_%s, %d, ", sc->name, sc->name, bytes * DL_STEPS_PER_BYTE);
+    if (sc->numSlots > 0)
+      fprintf(out, "slots_%s, %d, ", sc->name, sc->numSlots);
+    else
+      fprintf(out, "NULL, 0, ");
+    fprintf(out, "%d, %d, %d, { \"%s\", \"%s\" } },\n", bytes, sc->lines == 3, sc->lines,
+            sc->text[0], sc->text[1]);
+  }
+  fprintf(out, " };\n");
+}
+
+static void emitH (FILE *out, const char *src) {
+  char name[NAME_LEN + 16];
+  fprintf(out, "/*\n * Generated by mm-dlgen from %s, do not edit\n * For F28HS Coursework 2\n */\n\n", src);
+  fprintf(out, " #ifndef MM_DLISTS_H\n #define MM_DLISTS_H\n\n #include \"mm-dlist.h\"\n\n");
+  fprintf(out, " typedef enum {\n");
+  for (int k = 0; k < numScreens; k++) {
+    constName(name, screens[k].name);
+    fprintf(out, "     %s%s,\n", name, k == 0 ? " = 0" : "");
+  }
+  fprintf(out, "     NUM_SCREENS\n } DlScreen;\n\n");
+  fprintf(out, " extern DisplayList dlScreens[NUM_SCREENS];\n\n #endif // MM_DLISTS_H\n");
+}
+
+int main (int argc, char **argv) {
+  const char *cPath = "mm-dlists.c", *hPath = "mm-dlists.h";
+  FILE *out;
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <screens file>\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  if (!readScreens(argv[1]))
+    exit(EXIT_FAILURE);
+
+  if ((out = fopen(cPath, "w")) == NULL) {
+    perror(cPath);
+    exit(EXIT_FAILURE);
+  }
+  emitC(out, argv[1]);
+  fclose(out);
+
+  if ((out = fopen(hPath, "w")) == NULL) {
+    perror(hPath);
+    exit(EXIT_FAILURE);
+  }
+  emitH(out, argv[1]);
+  fclose(out);
+
+  fprintf(stderr, "%s: %d screens written to %s and %s\n", argv[0], numScreens, cPath, hPath);
+  return EXIT_SUCCESS;
+}
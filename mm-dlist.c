@@ -0,0 +1,100 @@
+/*
+ * Precompiled LCD display lists for the static screens
+ * For F28HS Coursework 2
+ *
+ * writeLineToLCD sends a screen one character at a time: every byte is a
+ * lcdByte call, six digitalWrite calls, four sleeps and the 100 us wait,
+ * and the text is the same each time the screen is shown. A display list
+ * is that bus waveform worked out once by mm-dlgen: per step a GPSET0 and
+ * a GPCLR0 mask (so the four data lines and RS change in one store) and
+ * the minimum hold before the next step. Replay is a loop of two stores
+ * and a wait, and each hold is timed from the store that starts it, so a
+ * late wake-up can stretch the bus but never make a step too short.
+ *
+ * Digits and counters are slots: dlPatch rewrites the nibble steps of
+ * their bytes in place, and the text copy that -S sends.
+ */
+
+ #include <stdio.h>
+ #include <stdarg.h>
+ #include <string.h>
+ #include "lcdBinary.h"
+ #include "mm-clock.h"
+ #include "mm-dlist.h"
+
+ // Global variables
+ int dlBytewise = 0;
+
+ static const uint32_t dataMask = (1u << LCD_RS) | (1u << LCD_D4) | (1u << LCD_D5) | (1u << LCD_D6) | (1u << LCD_D7);
+
+ // Set and clear masks of one data nibble, RS high
+ static void dlNibble(DlStep* s, unsigned nibble) {
+     uint32_t bits = (1u << LCD_RS) | (nibble & 1 ? 1u << LCD_D4 : 0) | (nibble & 2 ? 1u << LCD_D5 : 0) |
+                     (nibble & 4 ? 1u << LCD_D6 : 0) | (nibble & 8 ? 1u << LCD_D7 : 0);
+     s->set = bits;
+     s->clr = dataMask & ~bits;
+ }
+
+ // Fill a slot with text, padded with spaces (cut at the slot width)
+ void dlPatch(DisplayList* dl, int slot, const char* text) {
+     if (slot < 0 || slot >= dl->numSlots) return;
+     const DlSlot* sl = &dl->slots[slot];
+     int len = strlen(text);
+     
+     for (int i = 0; i < sl->width; i++) {
+         unsigned char c = i < len ? text[i] : ' ';
+         DlStep* s = dl->steps + sl->step + i * DL_STEPS_PER_BYTE;
+         dlNibble(&s[0], c >> 4);
+         dlNibble(&s[3], c & 15);
+         dl->text[sl->line][sl->col + i] = c;
+     }
+ }
+
+ void dlPatchf(DisplayList* dl, int slot, const char* fmt, ...) {
+     char buf[DL_LINE_MAX + 1];
+     va_list ap;
+     va_start(ap, fmt);
+     vsnprintf(buf, sizeof(buf), fmt, ap);
+     va_end(ap);
+     dlPatch(dl, slot, buf);
+ }
+
+ // Hold until deadline: short holds spin on the clock, long ones sleep
+ // (virtual time only moves while sleeping, so it always sleeps)
+ static void dlHold(uint64_t deadline) {
+     if (clockVirtual) {
+         clockSleepUntilNs(deadline);
+         return;
+     }
+     uint64_t now = clockNowNs();
+     if (deadline > now + DL_SPIN_NS) {
+         clockSleepUntilNs(deadline);
+         return;
+     }
+     while (clockNowNs() < deadline) {
+     }
+ }
+
+ // Play the whole list on the bus
+ void dlReplay(const DisplayList* dl) {
+     const DlStep* s = dl->steps;
+     const DlStep* end = s + dl->numSteps;
+     
+     for (; s < end; s++) {
+         writePins(s->set, s->clr);
+         dlHold(clockNowNs() + s->holdNs);
+     }
+     ioCounters.lcdBytes += dl->bytes;
+ }
+
+ // Show a screen: replay its list, or with -S send its text through lcdByte
+ void dlShow(const DisplayList* dl) {
+     if (!dlBytewise) {
+         dlReplay(dl);
+         return;
+     }
+     if (dl->clear) clearLCD();
+     for (int line = 0; line < 2; line++) {
+         if (dl->lines & (1 << line)) writeLineToLCD(dl->text[line], line);
+     }
+ }
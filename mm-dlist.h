@@ -0,0 +1,58 @@
+/*
+ * Precompiled LCD display lists for the static screens
+ * For F28HS Coursework 2
+ *
+ * mm-dlgen writes the lists (mm-dlists.c, mm-dlists.h) from mm-screens.txt
+ * at build time; this header is the hand-written interface to them.
+ */
+
+ #ifndef MM_DLIST_H
+ #define MM_DLIST_H
+
+ #include <stdint.h>
+
+ // Minimum hold after each kind of step (HD44780 timing, 4-bit bus)
+ #define DL_SETUP_NS 100          // Data and RS before EN rises (tAS 40 ns)
+ #define DL_EN_NS 1000            // EN high, then EN low before the next nibble
+ #define DL_EXEC_NS 40000         // Instruction execution (37 us)
+ #define DL_CLEAR_NS 1600000      // Clear display (1.52 ms)
+ #define DL_SPIN_NS 100000        // Shorter holds busy-wait instead of sleeping
+
+ #define DL_LINE_MAX 40           // DDRAM columns per line
+ #define DL_STEPS_PER_BYTE 6      // High nibble, EN up, EN down, low nibble, EN up, EN down
+
+ // One bus step: a GPSET0 and a GPCLR0 store, then a minimum hold
+ typedef struct {
+     uint32_t set, clr;
+     uint32_t holdNs;
+ } DlStep;
+
+ // A dynamic field: width characters whose first byte starts at step
+ typedef struct {
+     uint16_t step;
+     uint8_t line, col, width;
+ } DlSlot;
+
+ // A whole screen: optional clear, then either or both lines
+ typedef struct {
+     const char* name;
+     DlStep* steps;
+     int numSteps;
+     const DlSlot* slots;
+     int numSlots;
+     int bytes;                               // LCD bytes in the list
+     int clear;                               // Starts with a clear display
+     int lines;                               // Bit 0: line 0 is written, bit 1: line 1
+     char text[2][DL_LINE_MAX + 1];           // Current text, slots included
+ } DisplayList;
+
+ // Set by -S: send screens byte by byte through lcdByte, as before
+ extern int dlBytewise;
+
+ // Function prototypes for display lists
+ void dlPatch(DisplayList* dl, int slot, const char* text);
+ void dlPatchf(DisplayList* dl, int slot, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+ void dlReplay(const DisplayList* dl);
+ void dlShow(const DisplayList* dl);
+
+ #endif // MM_DLIST_H
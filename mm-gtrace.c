@@ -0,0 +1,269 @@
+/*
+ * Pin-level GPIO trace capture
+ * For F28HS Coursework 2
+ *
+ * A poor man's logic analyser. Every GPSET0/GPCLR0 write made through
+ * digitalWrite is timestamped into one ring, and a sampler thread polls
+ * GPLEV0 on the live /dev/mem mapping at a fixed rate, keeping only the
+ * samples where a game pin changed, in a second ring. Both rings are
+ * preallocated, so capturing never allocates or blocks. At the end they are
+ * merged and written out delta-coded, eight bytes per event; mm-gtvcd turns
+ * the file into a VCD for waveform viewers and mm-sim can replay the button.
+ */
+
+ #define _GNU_SOURCE
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <unistd.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include "mm-gtrace.h"
+ #include "lcdBinary.h"
+ #include "mm-clock.h"
+
+ #define GTRACE_DT_MAX ((1u << 30) - 1)
+ #define GTRACE_LEV_WORD 13     // GPLEV0, in words from the GPIO base
+
+ // Pins the sampler watches
+ #define GTRACE_PIN_MASK ((1u << GREEN_LED) | (1u << RED_LED) | (1u << BUTTON) | \
+                          (1u << LCD_RS) | (1u << LCD_EN) | (1u << LCD_D4) | \
+                          (1u << LCD_D5) | (1u << LCD_D6) | (1u << LCD_D7))
+
+ typedef struct {
+     GtraceEvent* events;
+     uint64_t head;
+ } GtraceRing;
+
+ // Global variables
+ int gtraceEnabled = 0;
+ static GtraceRing writeRing, sampleRing;
+ static const char* tracePath;
+ static volatile unsigned* gpioRegs;
+ static unsigned samplePeriodNs;
+ static uint64_t traceStartNs;
+ static pthread_t samplerThread;
+ static int samplerRunning = 0;
+ static volatile int samplerStop = 0;
+
+ // Same clock as the game, so a capture of a virtual-time run replays in step
+ static uint64_t gtraceNow(void) {
+     return clockNowNs();
+ }
+
+ // Append to a ring, overwriting the oldest event when full
+ static void ringPush(GtraceRing* r, uint64_t ns, uint32_t bits, uint32_t kind) {
+     GtraceEvent* ev = &r->events[r->head & (GTRACE_RING_EVENTS - 1)];
+     ev->ns = ns - traceStartNs;
+     ev->bits = bits;
+     ev->kind = kind;
+     r->head++;
+ }
+
+ // Oldest event still in a ring
+ static uint64_t ringFirst(const GtraceRing* r) {
+     return r->head > GTRACE_RING_EVENTS ? r->head - GTRACE_RING_EVENTS : 0;
+ }
+
+ // Sample GPLEV0 at a fixed rate. With a spare core the thread spins on the
+ // clock, since sleeps that short overshoot by tens of microseconds
+ static void* samplerMain(void* arg) {
+     int spin = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+     uint32_t last = ~0u;
+
+     if (spin) {
+         // Keep off the last core, which real-time mode gives the I/O thread
+         cpu_set_t set;
+         CPU_ZERO(&set);
+         CPU_SET(0, &set);
+         pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+     }
+
+     uint64_t next = gtraceNow();
+     while (!samplerStop) {
+         uint64_t now = gtraceNow();
+         uint32_t level = gpioRegs[GTRACE_LEV_WORD] & GTRACE_PIN_MASK;
+         if (level != last) {
+             ringPush(&sampleRing, now, level, GTRACE_LEV);
+             last = level;
+         }
+
+         next += samplePeriodNs;
+         if (next < now) next = now; // Fell behind, do not try to catch up
+         if (spin) {
+             while (gtraceNow() < next)
+                 ;
+         } else {
+             struct timespec ts = { next / 1000000000ull, next % 1000000000ull };
+             clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+         }
+     }
+     return NULL;
+ }
+
+ static void gtraceAtExit(void) {
+     gtraceStop();
+ }
+
+ // Start capturing to path. regs is the GPIO mapping from initGPIO; without
+ // one (the simulated backend) there is no sampler thread and levels only
+ // come in through gtraceSample. Returns 0 on failure
+ int gtraceStart(const char* path, volatile unsigned* regs, unsigned periodNs) {
+     writeRing.events = malloc(sizeof(GtraceEvent) * GTRACE_RING_EVENTS);
+     sampleRing.events = malloc(sizeof(GtraceEvent) * GTRACE_RING_EVENTS);
+     if (writeRing.events == NULL || sampleRing.events == NULL) {
+         fprintf(stderr, "Failed to allocate GPIO trace buffers\n");
+         free(writeRing.events);
+         free(sampleRing.events);
+         writeRing.events = sampleRing.events = NULL;
+         return 0;
+     }
+     // Touch every page now, so the first events do not fault
+     memset(writeRing.events, 0, sizeof(GtraceEvent) * GTRACE_RING_EVENTS);
+     memset(sampleRing.events, 0, sizeof(GtraceEvent) * GTRACE_RING_EVENTS);
+
+     tracePath = path;
+     gpioRegs = regs;
+     samplePeriodNs = periodNs;
+     traceStartNs = gtraceNow();
+     writeRing.head = sampleRing.head = 0;
+     samplerStop = 0;
+
+     if (regs != NULL) {
+         // A spinning sampler must never inherit SCHED_FIFO from the I/O thread
+         pthread_attr_t attr;
+         struct sched_param param = { 0 };
+         pthread_attr_init(&attr);
+         pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+         pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+         pthread_attr_setschedparam(&attr, &param);
+         samplerRunning = pthread_create(&samplerThread, &attr, samplerMain, NULL) == 0;
+         pthread_attr_destroy(&attr);
+         if (!samplerRunning) fprintf(stderr, "GPIO trace: no sampler thread, capturing writes only\n");
+     } else {
+         fprintf(stderr, "GPIO trace: no GPIO mapping, not sampling GPLEV0\n");
+     }
+
+     gtraceEnabled = 1;
+     atexit(gtraceAtExit);
+     return 1;
+ }
+
+ // Record a write to GPSET0/GPCLR0; called from digitalWrite on the I/O thread
+ void gtraceWrite(int pin, int value) {
+     ringPush(&writeRing, gtraceNow(), 1u << pin, value ? GTRACE_SET : GTRACE_CLR);
+ }
+
+ // Record a GPLEV0 value seen outside the sampler (the simulated backend has
+ // no registers to poll); only call it while no sampler thread runs
+ void gtraceSample(uint32_t level) {
+     ringPush(&sampleRing, gtraceNow(), level & GTRACE_PIN_MASK, GTRACE_LEV);
+ }
+
+ static void putRecord(FILE* f, uint32_t kind, uint32_t dt, uint32_t bits) {
+     uint32_t rec[2] = { kind << 30 | dt, bits };
+     fwrite(rec, sizeof(rec), 1, f);
+ }
+
+ // Stop capturing and write the trace file; safe to call more than once.
+ // Must run before the GPIO mapping goes away
+ void gtraceStop(void) {
+     if (!gtraceEnabled) return;
+     gtraceEnabled = 0;
+     if (samplerRunning) {
+         samplerStop = 1;
+         pthread_join(samplerThread, NULL);
+         samplerRunning = 0;
+     }
+
+     FILE* f = fopen(tracePath, "wb");
+     if (f == NULL) {
+         perror(tracePath);
+         return;
+     }
+
+     uint64_t w = ringFirst(&writeRing), s = ringFirst(&sampleRing);
+     GtraceHeader hdr;
+     memset(&hdr, 0, sizeof(hdr));
+     memcpy(hdr.magic, GTRACE_MAGIC, 4);
+     hdr.version = GTRACE_VERSION;
+     hdr.headerSize = sizeof(hdr);
+     hdr.periodNs = gpioRegs != NULL ? samplePeriodNs : 0;
+     hdr.pinMask = GTRACE_PIN_MASK;
+     hdr.dropped = w + s;
+     hdr.startNs = traceStartNs;
+     fwrite(&hdr, sizeof(hdr), 1, f);
+
+     // Merge the two rings by time, splitting long gaps with TIME records
+     uint64_t prev = 0;
+     uint32_t count = 0;
+     while (w < writeRing.head || s < sampleRing.head) {
+         const GtraceEvent* ev;
+         if (s >= sampleRing.head ||
+             (w < writeRing.head &&
+              writeRing.events[w & (GTRACE_RING_EVENTS - 1)].ns <=
+              sampleRing.events[s & (GTRACE_RING_EVENTS - 1)].ns)) {
+             ev = &writeRing.events[w++ & (GTRACE_RING_EVENTS - 1)];
+         } else {
+             ev = &sampleRing.events[s++ & (GTRACE_RING_EVENTS - 1)];
+         }
+         uint64_t dt = ev->ns > prev ? ev->ns - prev : 0;
+         while (dt > GTRACE_DT_MAX) {
+             putRecord(f, GTRACE_TIME, GTRACE_DT_MAX, 0);
+             dt -= GTRACE_DT_MAX;
+             count++;
+         }
+         putRecord(f, ev->kind, dt, ev->bits);
+         prev = ev->ns > prev ? ev->ns : prev;
+         count++;
+     }
+
+     // Now that the count is known
+     hdr.count = count;
+     fseek(f, 0, SEEK_SET);
+     fwrite(&hdr, sizeof(hdr), 1, f);
+     fclose(f);
+     fprintf(stderr, "GPIO trace: %u events written to %s (%u dropped)\n", count, tracePath, hdr.dropped);
+
+     free(writeRing.events);
+     free(sampleRing.events);
+     writeRing.events = sampleRing.events = NULL;
+ }
+
+ // Read a trace file into a malloc'd array of events (TIME records are
+ // folded into the timestamps). Returns the number of events, or -1
+ int gtraceLoad(const char* path, GtraceHeader* hdr, GtraceEvent** events) {
+     FILE* f = fopen(path, "rb");
+     if (f == NULL) {
+         perror(path);
+         return -1;
+     }
+     if (fread(hdr, sizeof(*hdr), 1, f) != 1 || memcmp(hdr->magic, GTRACE_MAGIC, 4) != 0 ||
+         hdr->version != GTRACE_VERSION) {
+         fprintf(stderr, "%s: not a GPIO trace\n", path);
+         fclose(f);
+         return -1;
+     }
+     fseek(f, hdr->headerSize, SEEK_SET);
+
+     GtraceEvent* ev = malloc(sizeof(GtraceEvent) * (hdr->count ? hdr->count : 1));
+     if (ev == NULL) {
+         fclose(f);
+         return -1;
+     }
+     uint64_t ns = 0;
+     int n = 0;
+     uint32_t rec[2];
+     for (uint32_t i = 0; i < hdr->count && fread(rec, sizeof(rec), 1, f) == 1; i++) {
+         ns += rec[0] & GTRACE_DT_MAX;
+         if (rec[0] >> 30 == GTRACE_TIME) continue;
+         ev[n].ns = ns;
+         ev[n].kind = rec[0] >> 30;
+         ev[n].bits = rec[1];
+         n++;
+     }
+     fclose(f);
+     *events = ev;
+     return n;
+ }
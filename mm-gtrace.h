@@ -0,0 +1,58 @@
+/*
+ * Pin-level GPIO trace capture
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_GTRACE_H
+ #define MM_GTRACE_H
+
+ #include <stdint.h>
+
+ #define GTRACE_MAGIC "MMGT"
+ #define GTRACE_VERSION 1
+ #define GTRACE_RING_EVENTS (1 << 18)   // Per ring, must be a power of two
+ #define GTRACE_PERIOD_NS 10000         // GPLEV0 sample period (100 kHz)
+
+ // Event kinds, stored in the top two bits of each record
+ typedef enum {
+     GTRACE_SET = 0,    // Write to GPSET0, bits = pins set
+     GTRACE_CLR,        // Write to GPCLR0, bits = pins cleared
+     GTRACE_LEV,        // GPLEV0 sample that differs from the last one
+     GTRACE_TIME        // No event, only advances the clock
+ } GtraceKind;
+
+ // File header; records follow as pairs of 32-bit words:
+ //   kind << 30 | ns since the previous record, then the pin bits
+ typedef struct {
+     char magic[4];
+     uint16_t version;
+     uint16_t headerSize;
+     uint32_t periodNs;     // Sample period of the GTRACE_LEV records
+     uint32_t pinMask;      // Pins the samples were taken from
+     uint32_t count;        // Records in the file
+     uint32_t dropped;      // Events lost to ring overflow
+     uint64_t startNs;      // CLOCK_MONOTONIC at gtraceStart
+ } GtraceHeader;
+
+ // A decoded event, time relative to the start of the capture
+ typedef struct {
+     uint64_t ns;
+     uint32_t bits;
+     uint32_t kind;
+ } GtraceEvent;
+
+ // Set by gtraceStart; write hooks cost one load and a branch when off
+ extern int gtraceEnabled;
+
+ #define GTRACE_WRITE(pin, value) do { if (gtraceEnabled) gtraceWrite(pin, value); } while (0)
+
+ // Function prototypes for capture
+ int gtraceStart(const char* path, volatile unsigned* regs, unsigned periodNs);
+ void gtraceWrite(int pin, int value);
+ void gtraceSample(uint32_t level);
+ void gtraceStop(void);
+
+ // Function prototypes for reading a capture back
+ int gtraceLoad(const char* path, GtraceHeader* hdr, GtraceEvent** events);
+
+ #endif // MM_GTRACE_H
@@ -0,0 +1,99 @@
+/*
+  Converts a GPIO trace (mastermind -g <file>) to VCD for waveform viewers
+
+$ make mm-gtvcd
+$ sudo ./mastermind -g game.gtr
+$ ./mm-gtvcd game.gtr > game.vcd
+$ gtkwave game.vcd
+
+  Pins the program drives take their edges from the GPSET0/GPCLR0 writes
+  (exact times); all other pins, the button in particular, come from the
+  GPLEV0 samples, so their edges are only as exact as the sample period.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "mm-gtrace.h"
+#include "lcdBinary.h"
+
+typedef struct {
+  const char *name;
+  int pin;
+} Wire;
+
+static const Wire wires[] = {
+  { "button", BUTTON },
+  { "green_led", GREEN_LED },
+  { "red_led", RED_LED },
+  { "lcd_rs", LCD_RS },
+  { "lcd_en", LCD_EN },
+  { "lcd_d4", LCD_D4 },
+  { "lcd_d5", LCD_D5 },
+  { "lcd_d6", LCD_D6 },
+  { "lcd_d7", LCD_D7 },
+};
+#define NUM_WIRES (int)(sizeof(wires) / sizeof(wires[0]))
+
+int main (int argc, char **argv) {
+  GtraceHeader hdr;
+  GtraceEvent *ev;
+  uint32_t written = 0, level = 0, known = 0;
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <trace file>\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  int n = gtraceLoad(argv[1], &hdr, &ev);
+  if (n < 0)
+    exit(EXIT_FAILURE);
+
+  // Pins that were ever written follow the writes only
+  for (int i = 0; i < n; i++)
+    if (ev[i].kind == GTRACE_SET || ev[i].kind == GTRACE_CLR)
+      written |= ev[i].bits;
+
+  printf("$version mm-gtvcd, %d events, sample period %u ns, %u dropped $end\n",
+         n, hdr.periodNs, hdr.dropped);
+  printf("$timescale 1ns $end\n$scope module mastermind $end\n");
+  for (int w = 0; w < NUM_WIRES; w++)
+    printf("$var wire 1 %c %s $end\n", '!' + w, wires[w].name);
+  printf("$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+  for (int w = 0; w < NUM_WIRES; w++)
+    printf("x%c\n", '!' + w);
+  printf("$end\n");
+
+  uint64_t stamp = 0;       // #0 is already open
+  for (int i = 0; i < n; i++) {
+    uint32_t next = level, mask;
+    switch (ev[i].kind) {
+    case GTRACE_SET:
+      next |= ev[i].bits;
+      mask = ev[i].bits;
+      break;
+    case GTRACE_CLR:
+      next &= ~ev[i].bits;
+      mask = ev[i].bits;
+      break;
+    default:
+      mask = ~written;
+      next = (level & written) | (ev[i].bits & mask);
+      break;
+    }
+
+    for (int w = 0; w < NUM_WIRES; w++) {
+      uint32_t bit = 1u << wires[w].pin;
+      if (!(mask & bit) || ((known & bit) && (next & bit) == (level & bit)))
+        continue;
+      if (ev[i].ns != stamp) {
+        printf("#%llu\n", (unsigned long long)ev[i].ns);
+        stamp = ev[i].ns;
+      }
+      printf("%d%c\n", (next & bit) != 0, '!' + w);
+      known |= bit;
+    }
+    level = next;
+  }
+  free(ev);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# Stand-in for qemu-arm and its insn and mem plugins, for checking
+# mm-iprof.sh itself on a box without an ARM toolchain or a QEMU build
+#
+# $ make iprof-selftest
+# $ QEMU=./mm-iprof-fake.sh ./mm-iprof.sh [-b <baseline>]
+#
+# Lists three made-up targets for -l, and for a counting run writes the
+# plugin lines ("insns: N", "mem accesses: N") to the -D log as QEMU
+# does: a fixed startup cost, a loop cost per call, and with the target
+# (not -0) a fixed cost per call. FAKE_REGRESS=<target> makes that target
+# one instruction and one memory access dearer per call; FAKE_FAIL=1 makes
+# every counting run fail, as a crash under QEMU would.
+
+LOG=/dev/null
+while [ $# -gt 0 ]; do
+  case $1 in
+    -plugin|-d) shift 2 ;;
+    -D) LOG=$2; shift 2 ;;
+    *) break ;;
+  esac
+done
+shift                                   # The harness binary
+
+if [ "$1" = "-l" ]; then
+  printf "%s\n" "matchesASM-4x6 exact" "matchesASM-4x6 mixed" "digitalWrite set"
+  exit 0
+fi
+
+EMPTY=0
+if [ "$1" = "-0" ]; then
+  EMPTY=1
+  shift
+fi
+target=$1 calls=$3
+[ -n "$FAKE_FAIL" ] && exit 1
+
+insns=$((5000 + 7 * calls))
+mem=$((1200 + 2 * calls))
+if [ $EMPTY -eq 0 ]; then
+  insns=$((insns + (20 + ${#target}) * calls))
+  mem=$((mem + 9 * calls))
+  if [ "$target" = "$FAKE_REGRESS" ]; then
+    insns=$((insns + calls))
+    mem=$((mem + calls))
+  fi
+fi
+printf "insns: %d\nmem accesses: %d\n" $insns $mem > "$LOG"
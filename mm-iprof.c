@@ -0,0 +1,234 @@
+/*
+  Instruction-count harness for the ARM assembly, run under qemu-user
+
+$ make iprof
+$ qemu-arm -plugin libinsn.so -d plugin arm/mm-iprof [-0] <target> <class> <calls>
+$ qemu-arm arm/mm-iprof -l
+
+  Calls one target <calls> times on inputs of one class and does nothing
+  else, so a run's instruction and memory-access counts are fixed by the
+  code alone. With -0 the target is replaced by an empty function of the
+  same signature and the same loop runs: the difference between the two
+  runs, divided by <calls>, is the exact cost per call, with process
+  startup, input setup and loop overhead taken out. mm-iprof.sh runs every
+  target and class both ways under the qemu insn and mem plugins.
+
+  Targets: matchesASM-<pegs>x<colours> and kernelASM-/kernelC-<pegs>x<colours>
+  for every generated geometry, and the GPIO register primitives of
+  lcdBinary.c (digitalWrite, digitalRead, pinMode, writeLEDs) driven
+  against a block of plain memory instead of /dev/mem.
+  -l lists every target with its classes, one pair per line.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mm-kernels.h"
+#include "mm-rng.h"
+#include "lcdBinary.h"
+
+#define PAIRS 64                // Pairs per class, cycled through by the loop
+#define MAX_PEGS 16
+
+extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
+
+typedef int (*MatchesFn)(int *, int *, int, int *, int *);
+typedef void (*PinWriteFn)(int, int);
+typedef int (*PinReadFn)(int);
+
+static const char *matchClasses[] = { "exact", "none", "approx", "mixed", NULL };
+static const char *writeClasses[] = { "set", "clear", NULL };
+static const char *modeClasses[] = { "output", "input", NULL };
+static const char *readClasses[] = { "read", NULL };
+static const char *ledClasses[] = { "mixed", NULL };
+
+static int pairs[2 * PAIRS * MAX_PEGS];
+static volatile unsigned fakeRegisters[64];
+static volatile int sink;
+
+// The empty stand-ins, one per signature
+__attribute__((noinline)) static int nullMatches(int *s, int *g, int n, int *e, int *a) {
+  __asm__ __volatile__("" ::: "memory");
+  return 0;
+}
+
+__attribute__((noinline)) static void nullKernel(const int *s, const int *g, int *e, int *a) {
+  __asm__ __volatile__("" ::: "memory");
+}
+
+__attribute__((noinline)) static void nullPinWrite(int pin, int value) {
+  __asm__ __volatile__("" ::: "memory");
+}
+
+__attribute__((noinline)) static int nullPinRead(int pin) {
+  __asm__ __volatile__("" ::: "memory");
+  return 0;
+}
+
+static int classIndex(const char **classes, const char *name) {
+  for (int i = 0; classes[i] != NULL; i++)
+    if (strcmp(classes[i], name) == 0)
+      return i;
+  return -1;
+}
+
+// PAIRS secret/guess pairs of one class: all exact, no colour in common,
+// the secret rotated by one peg (all approximate when pegs <= colours),
+// or random pairs from a fixed seed
+static void fillPairs(int cls, int length, int colors) {
+  Rng rng;
+  rngSeed(&rng, 1701);
+  for (int p = 0; p < PAIRS; p++) {
+    int *secret = pairs + 2 * p * length, *guess = secret + length;
+    for (int i = 0; i < length; i++) {
+      switch (cls) {
+      case 0:
+        secret[i] = guess[i] = i % colors + 1;
+        break;
+      case 1:
+        secret[i] = 1;
+        guess[i] = 2;
+        break;
+      case 2:
+        secret[i] = i % colors + 1;
+        guess[i] = (i + 1) % length % colors + 1;
+        break;
+      default:
+        secret[i] = rngBounded(&rng, colors) + 1;
+        guess[i] = rngBounded(&rng, colors) + 1;
+        break;
+      }
+    }
+  }
+}
+
+static void runMatches(MatchesFn fn, int length, long calls) {
+  int e, a, acc = 0;
+  for (long i = 0; i < calls; i++) {
+    int *secret = pairs + 2 * (i & (PAIRS - 1)) * length;
+    fn(secret, secret + length, length, &e, &a);
+    acc += e + a;
+  }
+  sink = acc;
+}
+
+static void runKernel(MatchKernel fn, int length, long calls) {
+  int e, a, acc = 0;
+  for (long i = 0; i < calls; i++) {
+    const int *secret = pairs + 2 * (i & (PAIRS - 1)) * length;
+    fn(secret, secret + length, &e, &a);
+    acc += e + a;
+  }
+  sink = acc;
+}
+
+static void runPinWrite(PinWriteFn fn, int pin, int value, long calls) {
+  for (long i = 0; i < calls; i++)
+    fn(pin, value);
+}
+
+static void runPinRead(PinReadFn fn, int pin, long calls) {
+  int acc = 0;
+  for (long i = 0; i < calls; i++)
+    acc += fn(pin);
+  sink = acc;
+}
+
+// writeLEDs through all four green/red combinations
+static void runLeds(PinWriteFn fn, long calls) {
+  for (long i = 0; i < calls; i++)
+    fn(i & 1, (i >> 1) & 1);
+}
+
+static void listTargets(void) {
+  for (int k = 0; k < numMatchKernels; k++) {
+    const KernelEntry *ke = &matchKernels[k];
+    for (int c = 0; matchClasses[c] != NULL; c++) {
+      printf("matchesASM-%dx%d %s\n", ke->length, ke->colors, matchClasses[c]);
+      if (ke->arm != NULL)
+        printf("kernelASM-%dx%d %s\n", ke->length, ke->colors, matchClasses[c]);
+      printf("kernelC-%dx%d %s\n", ke->length, ke->colors, matchClasses[c]);
+    }
+  }
+  for (int c = 0; writeClasses[c] != NULL; c++)
+    printf("digitalWrite %s\n", writeClasses[c]);
+  printf("digitalRead %s\n", readClasses[0]);
+  for (int c = 0; modeClasses[c] != NULL; c++)
+    printf("pinMode %s\n", modeClasses[c]);
+  printf("writeLEDs %s\n", ledClasses[0]);
+}
+
+// Run a scoring target (matchesASM-, kernelASM-, kernelC-<pegs>x<colours>)
+static int runScoring(const char *target, const char *class, long calls, int null) {
+  char kind[16];
+  int length, colors, cls = classIndex(matchClasses, class);
+  if (sscanf(target, "%15[^-]-%dx%d", kind, &length, &colors) != 3 || cls < 0)
+    return 0;
+
+  const KernelEntry *ke = NULL;
+  for (int k = 0; k < numMatchKernels; k++)
+    if (matchKernels[k].length == length && matchKernels[k].colors == colors)
+      ke = &matchKernels[k];
+  if (ke == NULL || length > MAX_PEGS)
+    return 0;
+
+  fillPairs(cls, length, colors);
+  if (strcmp(kind, "matchesASM") == 0) {
+    runMatches(null ? nullMatches : matchesASM, length, calls);
+  } else if (strcmp(kind, "kernelASM") == 0 && ke->arm != NULL) {
+    runKernel(null ? nullKernel : ke->arm, length, calls);
+  } else if (strcmp(kind, "kernelC") == 0) {
+    runKernel(null ? nullKernel : ke->c, length, calls);
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+// Run a GPIO primitive against the fake register block
+static int runGpio(const char *target, const char *class, long calls, int null) {
+  gpioUseRegisters(fakeRegisters);
+  if (strcmp(target, "digitalWrite") == 0 && classIndex(writeClasses, class) >= 0) {
+    runPinWrite(null ? nullPinWrite : digitalWrite, GREEN_LED, strcmp(class, "set") == 0, calls);
+  } else if (strcmp(target, "digitalRead") == 0 && classIndex(readClasses, class) >= 0) {
+    runPinRead(null ? nullPinRead : digitalRead, BUTTON, calls);
+  } else if (strcmp(target, "pinMode") == 0 && classIndex(modeClasses, class) >= 0) {
+    runPinWrite(null ? nullPinWrite : pinMode, LCD_D4, strcmp(class, "output") == 0 ? OUTPUT : INPUT, calls);
+  } else if (strcmp(target, "writeLEDs") == 0 && classIndex(ledClasses, class) >= 0) {
+    runLeds(null ? nullPinWrite : writeLEDs, calls);
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+int main (int argc, char **argv) {
+  int opt, null = 0;
+
+  while ((opt = getopt(argc, argv, "0l")) != -1) {
+    switch (opt) {
+    case '0':
+      null = 1;
+      break;
+    case 'l':
+      listTargets();
+      return 0;
+    default: /* '?' */
+      fprintf(stderr, "Usage: %s [-0] <target> <class> <calls> | -l\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (argc != optind + 3) {
+    fprintf(stderr, "Usage: %s [-0] <target> <class> <calls> | -l\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  const char *target = argv[optind], *class = argv[optind + 1];
+  long calls = atol(argv[optind + 2]);
+  if (!runScoring(target, class, calls, null) && !runGpio(target, class, calls, null)) {
+    fprintf(stderr, "Unknown target or class: %s %s (see -l)\n", target, class);
+    exit(EXIT_FAILURE);
+  }
+  return 0;
+}
@@ -0,0 +1,71 @@
+#!/bin/bash
+
+# Exact instructions and memory accesses per call of the ARM assembly,
+# counted by the qemu-user insn and mem plugins (see mm-iprof.c)
+#
+# $ ./mm-iprof.sh [-b <baseline>] [-o <out>]
+#
+# Every target and input class of arm/mm-iprof runs twice, once with the
+# target and once with an empty stand-in (-0); the difference divided by
+# the number of calls is the cost of one call. The table goes to <out>
+# (iprof.txt). With -b, any count above the baseline fails the run.
+
+# The counting loop feeds tee: a failed run must still fail the script
+set -o pipefail
+
+QEMU=${QEMU:-qemu-arm}
+QEMU_PLUGINS=${QEMU_PLUGINS:-/usr/local/lib/qemu/plugins}
+CALLS=${CALLS:-1000}
+BIN=${BIN:-arm/mm-iprof}
+OUT=iprof.txt
+BASELINE=
+
+while getopts "b:o:" opt; do
+  case $opt in
+    b) BASELINE=$OPTARG ;;
+    o) OUT=$OPTARG ;;
+    *) echo "Usage: $0 [-b <baseline>] [-o <out>]" >&2; exit 1 ;;
+  esac
+done
+
+for p in libinsn.so libmem.so; do
+  if [ ! -f "$QEMU_PLUGINS/$p" ]; then
+    echo "No $QEMU_PLUGINS/$p: set QEMU_PLUGINS to the plugins of a QEMU build" >&2
+    exit 1
+  fi
+done
+
+LOG=$(mktemp)
+trap 'rm -f "$LOG"' EXIT
+
+# Prints "<insns> <mem accesses>" for one run of the harness
+count() {
+  "$QEMU" -plugin "$QEMU_PLUGINS/libinsn.so" -plugin "$QEMU_PLUGINS/libmem.so" \
+    -d plugin -D "$LOG" "$BIN" "$@" > /dev/null || return 1
+  local insns mem
+  insns=$(sed -n 's/.*insns: *\([0-9][0-9]*\).*/\1/p' "$LOG" | tail -1)
+  mem=$(sed -n 's/.*mem accesses: *\([0-9][0-9]*\).*/\1/p' "$LOG" | tail -1)
+  echo "${insns:-0} ${mem:-0}"
+}
+
+TARGETS=$("$QEMU" "$BIN" -l) || exit 1
+printf "%-18s %-8s %10s %10s\n" "target" "class" "insns" "mem" | tee "$OUT"
+while read -r target class; do
+  full=$(count "$target" "$class" "$CALLS") || exit 1
+  empty=$(count -0 "$target" "$class" "$CALLS") || exit 1
+  echo "$full $empty" | awk -v t="$target" -v c="$class" -v n="$CALLS" \
+    '{ printf "%-18s %-8s %10.2f %10.2f\n", t, c, ($1 - $3) / n, ($2 - $4) / n }'
+done <<< "$TARGETS" | tee -a "$OUT" || exit 1
+
+# Regression check: any target and class that got dearer
+if [ -n "$BASELINE" ]; then
+  awk 'NR == FNR { if (FNR > 1) { insns[$1 " " $2] = $3; mem[$1 " " $2] = $4 } next }
+       FNR > 1 && ($1 " " $2) in insns {
+         if ($3 > insns[$1 " " $2] || $4 > mem[$1 " " $2]) {
+           printf "REGRESSION %s %s: %s insns %s mem, baseline %s %s\n", $1, $2, $3, $4, insns[$1 " " $2], mem[$1 " " $2]
+           bad = 1
+         }
+       }
+       END { exit bad }' "$BASELINE" "$OUT" || exit 1
+  echo "No regressions against $BASELINE"
+fi
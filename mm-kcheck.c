@@ -0,0 +1,168 @@
+/*
+  Check and time the generated scoring kernels against matchesASM
+
+$ make mm-kcheck
+$ ./mm-kcheck [-n <pairs>] [-s <seed>] [-P]
+
+  For every geometry in the dispatch table, every secret/guess pair (or -n
+  random pairs on boards too big to enumerate) is scored by matchesASM and
+  by each generated kernel, and any disagreement is printed. Then each
+  implementation scores the same buffer of pairs to report ns/call.
+  With -P the timed loops also count cycles, instructions, branch and
+  cache misses (mm-perf.c) and a table of per-call counts and IPC follows.
+  Exits with status 1 if any kernel disagrees with matchesASM.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "mm-kernels.h"
+#include "mm-rng.h"
+#include "mm-perf.h"
+
+#define BENCH_PAIRS 4096
+#define BENCH_ROUNDS 256
+
+extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
+
+static int benchLength;
+
+static void referenceKernel(const int *secret, const int *guess, int *exact, int *approx) {
+  matchesASM((int *)secret, (int *)guess, benchLength, exact, approx);
+}
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Fill code from a number in base colors, pegs 1..colors
+static void codeFrom(long long idx, int *code, int length, int colors) {
+  for (int i = length - 1; i >= 0; i--) {
+    code[i] = idx % colors + 1;
+    idx /= colors;
+  }
+}
+
+static void showSeq(const int *seq, int length) {
+  for (int i = 0; i < length; i++)
+    printf("%d", seq[i]);
+}
+
+// Compare one kernel against matchesASM on n pairs, returns mismatches
+static long long checkKernel(const char *name, MatchKernel kernel, int length, int colors,
+                             long long n, Rng *rng) {
+  long long codes = 1, bad = 0;
+  int secret[16], guess[16];
+  for (int i = 0; i < length; i++)
+    codes *= colors;
+  int exhaustive = codes <= n / codes;
+  if (exhaustive) n = codes * codes;
+
+  for (long long p = 0; p < n; p++) {
+    int e1, a1, e2, a2;
+    if (exhaustive) {
+      codeFrom(p / codes, secret, length, colors);
+      codeFrom(p % codes, guess, length, colors);
+    } else {
+      for (int i = 0; i < length; i++) {
+        secret[i] = rngBounded(rng, colors) + 1;
+        guess[i] = rngBounded(rng, colors) + 1;
+      }
+    }
+    matchesASM(secret, guess, length, &e1, &a1);
+    kernel(secret, guess, &e2, &a2);
+    if (e1 != e2 || a1 != a2) {
+      if (bad++ < 5) {
+        printf("  %s: ", name);
+        showSeq(secret, length);
+        printf(" ");
+        showSeq(guess, length);
+        printf(" gives %d %d, matchesASM %d %d\n", e2, a2, e1, a1);
+      }
+    }
+  }
+  printf("  %-10s %lld %s pairs, %lld mismatches\n", name, n, exhaustive ? "(all)" : "random", bad);
+  return bad;
+}
+
+// Average ns per call over the benchmark buffer, counted as region (-1: none)
+static double timeKernel(MatchKernel kernel, const int *pairs, int length, int region) {
+  volatile int sink = 0;
+  PerfMark perf;
+  PERF_BEGIN(&perf);
+  uint64_t t1 = nowNs();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int p = 0; p < BENCH_PAIRS; p++) {
+      int e, a;
+      kernel(pairs + 2 * p * length, pairs + (2 * p + 1) * length, &e, &a);
+      sink += e + a;
+    }
+  }
+  uint64_t t2 = nowNs();
+  if (perfEnabled && region >= 0)
+    perfEnd(&perf, region, (uint64_t)BENCH_ROUNDS * BENCH_PAIRS);
+  (void)sink;
+  return (double)(t2 - t1) / ((double)BENCH_ROUNDS * BENCH_PAIRS);
+}
+
+int main (int argc, char **argv) {
+  long long n = 1 << 20;
+  unsigned long long seed = 1701;
+  int opt, failed = 0;
+  Rng rng;
+
+  while ((opt = getopt(argc, argv, "n:s:P")) != -1) {
+    switch (opt) {
+    case 'n':
+      n = atoll(optarg);
+      break;
+    case 's':
+      seed = strtoull(optarg, NULL, 10);
+      break;
+    case 'P':
+      perfInit(0);
+      break;
+    default: /* '?' */
+      fprintf(stderr, "Usage: %s [-n <pairs>] [-s <seed>] [-P]\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  rngSeed(&rng, seed);
+
+  for (int k = 0; k < numMatchKernels; k++) {
+    const KernelEntry *ke = &matchKernels[k];
+    int length = ke->length, colors = ke->colors;
+    int *pairs = malloc(sizeof(int) * 2 * BENCH_PAIRS * length);
+
+    printf("%dx%d:\n", length, colors);
+    failed |= checkKernel("C", ke->c, length, colors, n, &rng) != 0;
+    if (ke->arm != NULL)
+      failed |= checkKernel("ASM", ke->arm, length, colors, n, &rng) != 0;
+
+    for (int i = 0; i < 2 * BENCH_PAIRS * length; i++)
+      pairs[i] = rngBounded(&rng, colors) + 1;
+    benchLength = length;
+    char name[PERF_NAME_LEN];
+    snprintf(name, sizeof(name), "%dx%d matchesASM", length, colors);
+    double ref = timeKernel(referenceKernel, pairs, length, perfEnabled ? perfRegion(name) : -1);
+    snprintf(name, sizeof(name), "%dx%d C", length, colors);
+    double c = timeKernel(ke->c, pairs, length, perfEnabled ? perfRegion(name) : -1);
+    printf("  matchesASM %6.1f ns/call\n", ref);
+    printf("  C          %6.1f ns/call (%.1fx)\n", c, ref / c);
+    if (ke->arm != NULL) {
+      snprintf(name, sizeof(name), "%dx%d ASM", length, colors);
+      double a = timeKernel(ke->arm, pairs, length, perfEnabled ? perfRegion(name) : -1);
+      printf("  ASM        %6.1f ns/call (%.1fx)\n", a, ref / a);
+    }
+    free(pairs);
+  }
+
+  if (perfEnabled)
+    perfReport(stdout);
+  printf("%s\n", failed ? "FAILED" : "All kernels agree with matchesASM");
+  return failed ? 1 : 0;
+}
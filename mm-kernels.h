@@ -0,0 +1,28 @@
+/*
+ * Generated fully-unrolled scoring kernels, one per board geometry
+ * For F28HS Coursework 2
+ *
+ * mm-kgen writes the kernels (mm-kernels.c, mm-kernels-arm.s) at build
+ * time; this header is the hand-written interface to them.
+ */
+
+ #ifndef MM_KERNELS_H
+ #define MM_KERNELS_H
+
+ // Same argument order as matchesASM, with the length baked in
+ typedef void (*MatchKernel)(const int* secret, const int* guess, int* exactMatches, int* approxMatches);
+
+ typedef struct {
+     int length, colors;
+     MatchKernel c;      // Branch-free C kernel
+     MatchKernel arm;    // ARM assembly kernel, NULL when not built for ARM
+ } KernelEntry;
+
+ // Dispatch table, in generation order
+ extern const KernelEntry matchKernels[];
+ extern const int numMatchKernels;
+
+ // Function prototypes for kernel dispatch
+ MatchKernel findKernel(int length, int colors);
+
+ #endif // MM_KERNELS_H
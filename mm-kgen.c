@@ -0,0 +1,205 @@
+/*
+  Generator for fully-unrolled MasterMind scoring kernels
+
+$ gcc -o mm-kgen mm-kgen.c
+$ ./mm-kgen 3x3 4x6 5x8 8x10
+
+  Writes mm-kernels.c (branch-free C kernels plus the dispatch table) and
+  mm-kernels-arm.s (ARM kernels, no loops and no branches) for every
+  <pegs>x<colours> geometry on the command line. Run from the Makefile, so
+  the kernels are regenerated whenever the geometry list changes.
+
+  Both flavours score with colour histograms packed four bits per colour:
+  one shift-add per peg builds the histogram, and the approximate count is
+  the sum over colours of min(secret, guess) minus the exact matches.
+  That is the same answer matchesASM computes with its marking loops.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_GEOMETRIES 32
+#define MAX_PEGS 15             // per-colour counts must fit in a nibble
+#define MAX_COLORS 15           // colour nibbles must fit in 64 bits
+
+typedef struct {
+  int pegs, colors;
+} Geometry;
+
+static Geometry geo[MAX_GEOMETRIES];
+static int numGeo = 0;
+
+static void emitC (FILE *out) {
+  fprintf(out, "/*\n * Generated by mm-kgen, do not edit\n * For F28HS Coursework 2\n */\n\n");
+  fprintf(out, " #include <stdint.h>\n #include <stddef.h>\n #include \"mm-kernels.h\"\n\n");
+
+  for (int k = 0; k < numGeo; k++) {
+    int n = geo[k].pegs, c = geo[k].colors;
+
+    fprintf(out, " // %d pegs, %d colours\n", n, c);
+    fprintf(out, " void kernelC_%dx%d(const int* secret, const int* guess, int* exactMatches, int* approxMatches) {\n", n, c);
+    for (int i = 0; i < n; i++)
+      fprintf(out, "     int s%d = secret[%d], g%d = guess[%d];\n", i, i, i, i);
+
+    fprintf(out, "     int exact =");
+    for (int i = 0; i < n; i++)
+      fprintf(out, "%s (s%d == g%d)", i ? " +" : "", i, i);
+    fprintf(out, ";\n");
+
+    fprintf(out, "     uint64_t hs =");
+    for (int i = 0; i < n; i++)
+      fprintf(out, "%s (1ull << (4 * s%d))", i ? " +" : "", i);
+    fprintf(out, ";\n");
+    fprintf(out, "     uint64_t hg =");
+    for (int i = 0; i < n; i++)
+      fprintf(out, "%s (1ull << (4 * g%d))", i ? " +" : "", i);
+    fprintf(out, ";\n");
+
+    fprintf(out, "     int total = 0, a, b;\n");
+    for (int col = 1; col <= c; col++) {
+      fprintf(out, "     a = (int)(hs >> %d) & 15; b = (int)(hg >> %d) & 15; total += b + ((a - b) & -(a < b));\n",
+              4 * col, 4 * col);
+    }
+    fprintf(out, "     *exactMatches = exact;\n");
+    fprintf(out, "     *approxMatches = total - exact;\n");
+    fprintf(out, " }\n\n");
+  }
+
+  fprintf(out, " #ifdef __arm__\n");
+  for (int k = 0; k < numGeo; k++) {
+    fprintf(out, " void kernelASM_%dx%d(const int* secret, const int* guess, int* exactMatches, int* approxMatches);\n",
+            geo[k].pegs, geo[k].colors);
+  }
+  fprintf(out, " #define ARM_KERNEL(name) name\n");
+  fprintf(out, " #else\n");
+  fprintf(out, " #define ARM_KERNEL(name) NULL\n");
+  fprintf(out, " #endif\n\n");
+
+  fprintf(out, " const KernelEntry matchKernels[] = {\n");
+  for (int k = 0; k < numGeo; k++) {
+    int n = geo[k].pegs, c = geo[k].colors;
+    fprintf(out, "     { %d, %d, kernelC_%dx%d, ARM_KERNEL(kernelASM_%dx%d) },\n", n, c, n, c, n, c);
+  }
+  fprintf(out, " };\n\n");
+  fprintf(out, " const int numMatchKernels = %d;\n\n", numGeo);
+
+  fprintf(out, " // Kernel for a board: exact peg count, and the first one with enough colours\n");
+  fprintf(out, " // (a kernel scores any code whose colours fit its histogram). Prefers the\n");
+  fprintf(out, " // ARM kernel when there is one, NULL if no kernel fits\n");
+  fprintf(out, " MatchKernel findKernel(int length, int colors) {\n");
+  fprintf(out, "     for (int i = 0; i < numMatchKernels; i++) {\n");
+  fprintf(out, "         const KernelEntry* k = &matchKernels[i];\n");
+  fprintf(out, "         if (k->length == length && k->colors >= colors) return k->arm ? k->arm : k->c;\n");
+  fprintf(out, "     }\n");
+  fprintf(out, "     return NULL;\n");
+  fprintf(out, " }\n");
+}
+
+/*
+  Register use in the ARM kernels:
+    r0 secret, r1 guess, r2 &exact, r3 &approx
+    r4 secret peg / min, r5 guess peg, r6 exact count, r7 constant 1 then total
+    r8/r9 secret histogram (colours 0-7 / 8-15), r10/r11 guess histogram
+    r12 shift amount
+  A register-specified LSL by 32 or more gives 0, so every peg is added to
+  both histogram words and lands in exactly one of them.
+*/
+static void emitARM (FILE *out) {
+  fprintf(out, "/*\n * Generated by mm-kgen, do not edit\n * For F28HS Coursework 2\n *\n");
+  fprintf(out, " * Same interface as matchesASM minus the length:\n");
+  fprintf(out, " *   r0 - pointer to secret array\n *   r1 - pointer to guess array\n");
+  fprintf(out, " *   r2 - pointer to store exact matches\n *   r3 - pointer to store approximate matches\n */\n\n");
+  fprintf(out, ".text\n\n");
+
+  for (int k = 0; k < numGeo; k++) {
+    int n = geo[k].pegs, c = geo[k].colors;
+    int high = c >= 8;
+
+    fprintf(out, "@ %d pegs, %d colours\n", n, c);
+    fprintf(out, ".global kernelASM_%dx%d\n", n, c);
+    fprintf(out, ".align 2\n");
+    fprintf(out, "kernelASM_%dx%d:\n", n, c);
+    fprintf(out, "    push {r4-r11, lr}\n");
+    fprintf(out, "    mov r6, #0\n    mov r7, #1\n    mov r8, #0\n    mov r10, #0\n");
+    if (high)
+      fprintf(out, "    mov r9, #0\n    mov r11, #0\n");
+
+    for (int i = 0; i < n; i++) {
+      fprintf(out, "    ldr r4, [r0, #%d]\n", 4 * i);
+      fprintf(out, "    ldr r5, [r1, #%d]\n", 4 * i);
+      fprintf(out, "    cmp r4, r5\n");
+      fprintf(out, "    addeq r6, r6, #1\n");
+      fprintf(out, "    mov r12, r4, lsl #2\n");
+      fprintf(out, "    add r8, r8, r7, lsl r12\n");
+      if (high) {
+        fprintf(out, "    sub r12, r12, #32\n");
+        fprintf(out, "    add r9, r9, r7, lsl r12\n");
+      }
+      fprintf(out, "    mov r12, r5, lsl #2\n");
+      fprintf(out, "    add r10, r10, r7, lsl r12\n");
+      if (high) {
+        fprintf(out, "    sub r12, r12, #32\n");
+        fprintf(out, "    add r11, r11, r7, lsl r12\n");
+      }
+    }
+
+    fprintf(out, "    mov r7, #0\n");
+    for (int col = 1; col <= c; col++) {
+      int hs = col < 8 ? 8 : 9, hg = col < 8 ? 10 : 11;
+      int shift = 4 * (col % 8);
+      fprintf(out, "    and r4, r%d, #0x%x\n", hs, 0xFu << shift);
+      fprintf(out, "    and r5, r%d, #0x%x\n", hg, 0xFu << shift);
+      fprintf(out, "    cmp r4, r5\n");
+      fprintf(out, "    movhi r4, r5\n");
+      if (shift)
+        fprintf(out, "    add r7, r7, r4, lsr #%d\n", shift);
+      else
+        fprintf(out, "    add r7, r7, r4\n");
+    }
+    fprintf(out, "    str r6, [r2]\n");
+    fprintf(out, "    sub r7, r7, r6\n");
+    fprintf(out, "    str r7, [r3]\n");
+    fprintf(out, "    pop {r4-r11, pc}\n\n");
+  }
+}
+
+int main (int argc, char **argv) {
+  const char *cPath = "mm-kernels.c", *asmPath = "mm-kernels-arm.s";
+  FILE *out;
+
+  for (int i = 1; i < argc; i++) {
+    Geometry g;
+    if (sscanf(argv[i], "%dx%d", &g.pegs, &g.colors) != 2 ||
+        g.pegs < 1 || g.pegs > MAX_PEGS || g.colors < 1 || g.colors > MAX_COLORS) {
+      fprintf(stderr, "%s: bad geometry '%s' (want <pegs>x<colours>, at most %dx%d)\n",
+              argv[0], argv[i], MAX_PEGS, MAX_COLORS);
+      exit(EXIT_FAILURE);
+    }
+    if (numGeo == MAX_GEOMETRIES) {
+      fprintf(stderr, "%s: at most %d geometries\n", argv[0], MAX_GEOMETRIES);
+      exit(EXIT_FAILURE);
+    }
+    geo[numGeo++] = g;
+  }
+  if (numGeo == 0) {
+    fprintf(stderr, "Usage: %s <pegs>x<colours> ...\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  if ((out = fopen(cPath, "w")) == NULL) {
+    perror(cPath);
+    exit(EXIT_FAILURE);
+  }
+  emitC(out);
+  fclose(out);
+
+  if ((out = fopen(asmPath, "w")) == NULL) {
+    perror(asmPath);
+    exit(EXIT_FAILURE);
+  }
+  emitARM(out);
+  fclose(out);
+
+  fprintf(stderr, "%s: %d kernels written to %s and %s\n", argv[0], numGeo, cPath, asmPath);
+  return EXIT_SUCCESS;
+}
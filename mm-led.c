@@ -0,0 +1,143 @@
+/*
+ * LED feedback encodings: classic blinks, PWM brightness, pulse codes
+ * For F28HS Coursework 2
+ *
+ * The classic protocol blinks green once per exact peg, red once, then
+ * green once per approximate peg, 400 ms a blink: reading one score takes
+ * up to 3 s and the next-round signal another 1.2 s. Both LEDs can carry a
+ * count at the same time instead. In PWM mode each LED is driven at 100 Hz
+ * with a duty cycle that grows with the square of its count (the eye is
+ * closer to logarithmic than linear), so a score is two brightness levels
+ * shown together for 300 ms. In pulse mode the counts are short pulses, 10
+ * per second, on both LEDs in parallel. Both modes start with a brief sync
+ * flash, so a (0,0) score is still seen.
+ *
+ * Every edge is timed against an absolute deadline from the start of the
+ * pattern, so late wake-ups do not accumulate, and each edge is one GPSET0
+ * store and one GPCLR0 store (writeLEDs).
+ */
+
+ #include <stdio.h>
+ #include <string.h>
+ #include <stdint.h>
+ #include "lcdBinary.h"
+ #include "mm-clock.h"
+ #include "mm-led.h"
+
+ // Global variables
+ LedMode ledMode = LED_MODE_BLINK;
+
+ static const char* modeNames[] = { "blink", "pwm", "pulse" };
+
+ // Select the mode by name; returns 1 on success
+ int ledModeParse(const char* name) {
+     for (int i = 0; i < (int)(sizeof(modeNames) / sizeof(modeNames[0])); i++) {
+         if (strcmp(name, modeNames[i]) == 0) {
+             ledMode = (LedMode)i;
+             return 1;
+         }
+     }
+     fprintf(stderr, "Error: unknown LED mode '%s' (blink, pwm or pulse)\n", name);
+     return 0;
+ }
+
+ // On-time per PWM period for count out of length, gamma 2
+ static uint64_t pwmOnNs(int count, int length) {
+     if (count <= 0 || length <= 0) return 0;
+     if (count >= length) return LED_PWM_PERIOD_US * 1000ull;
+     return LED_PWM_PERIOD_US * 1000ull * count * count / (length * length);
+ }
+
+ // Drive both LEDs for ms milliseconds; the on-times are per period and
+ // may change over the pattern through the step callback (NULL: constant)
+ static void pwmRun(uint64_t greenNs, uint64_t redNs, uint64_t ms,
+                    void (*step)(uint64_t elapsed, uint64_t total, uint64_t* green, uint64_t* red)) {
+     uint64_t period = LED_PWM_PERIOD_US * 1000ull;
+     uint64_t start = clockNowNs();
+     uint64_t periods = ms * 1000 / LED_PWM_PERIOD_US;
+
+     for (uint64_t p = 0; p < periods; p++) {
+         uint64_t t0 = start + p * period;
+         if (step != NULL) step(p * period, periods * period, &greenNs, &redNs);
+
+         // Both on at the start of the period, each off at its own deadline
+         clockSleepUntilNs(t0);
+         writeLEDs(greenNs > 0, redNs > 0);
+         uint64_t first = greenNs < redNs ? greenNs : redNs;
+         uint64_t last = greenNs < redNs ? redNs : greenNs;
+         if (first > 0 && first < period) {
+             clockSleepUntilNs(t0 + first);
+             writeLEDs(greenNs > first, redNs > first);
+         }
+         if (last > first && last < period) {
+             clockSleepUntilNs(t0 + last);
+             writeLEDs(0, 0);
+         }
+     }
+     clockSleepUntilNs(start + periods * period);
+     writeLEDs(0, 0);
+ }
+
+ // Pulses on both LEDs in parallel: slot i lights green if i < green, red if i < red
+ static void pulseRun(int green, int red) {
+     uint64_t on = LED_PULSE_ON_MS * 1000000ull;
+     uint64_t slot = (LED_PULSE_ON_MS + LED_PULSE_GAP_MS) * 1000000ull;
+     int slots = green > red ? green : red;
+     uint64_t start = clockNowNs();
+
+     for (int i = 0; i < slots; i++) {
+         clockSleepUntilNs(start + i * slot);
+         writeLEDs(i < green, i < red);
+         clockSleepUntilNs(start + i * slot + on);
+         writeLEDs(0, 0);
+     }
+     clockSleepUntilNs(start + slots * slot);
+ }
+
+ // A short flash of both marks the start of a score, so (0,0) is still seen
+ static void syncFlash(void) {
+     uint64_t start = clockNowNs();
+     writeLEDs(1, 1);
+     clockSleepUntilNs(start + LED_SYNC_MS * 1000000ull);
+     writeLEDs(0, 0);
+     clockSleepUntilNs(start + (LED_SYNC_MS + LED_PULSE_GAP_MS) * 1000000ull);
+ }
+
+ void ledShowScore(int exact, int approx, int length) {
+     switch (ledMode) {
+         case LED_MODE_PWM:
+             syncFlash();
+             pwmRun(pwmOnNs(exact, length), pwmOnNs(approx, length), LED_PWM_SHOW_MS, NULL);
+             break;
+         case LED_MODE_PULSE:
+             syncFlash();
+             pulseRun(exact, approx);
+             break;
+         default:
+             blinkLED(GREEN_LED, exact);   // Exact matches
+             blinkLED(RED_LED, 1);         // Separator
+             blinkLED(GREEN_LED, approx);  // Approximate matches
+             break;
+     }
+ }
+
+ // Red from full brightness to off over the fade
+ static void fadeStep(uint64_t elapsed, uint64_t total, uint64_t* green, uint64_t* red) {
+     uint64_t left = total - elapsed;
+     *green = 0;
+     *red = LED_PWM_PERIOD_US * 1000ull * left / total * left / total;
+ }
+
+ void ledSignalNextRound(void) {
+     switch (ledMode) {
+         case LED_MODE_PWM:
+             pwmRun(0, 0, LED_PWM_FADE_MS, fadeStep);
+             break;
+         case LED_MODE_PULSE:
+             pulseRun(0, 3);
+             break;
+         default:
+             blinkLED(RED_LED, 3);
+             break;
+     }
+ }
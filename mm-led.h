@@ -0,0 +1,30 @@
+/*
+ * LED feedback encodings: classic blinks, PWM brightness, pulse codes
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_LED_H
+ #define MM_LED_H
+
+ #define LED_PWM_PERIOD_US 10000    // 100 Hz, above flicker fusion
+ #define LED_PWM_SHOW_MS 300        // One score as two brightness levels
+ #define LED_PWM_FADE_MS 150        // Next round: red fades out
+ #define LED_PULSE_ON_MS 40         // Pulse code: one count
+ #define LED_PULSE_GAP_MS 60
+ #define LED_SYNC_MS 20             // Both LEDs, marks the start of a PWM or pulse score
+
+ // How counts are shown on the two LEDs
+ typedef enum {
+     LED_MODE_BLINK = 0,    // Green per exact, red separator, green per approx (400 ms each)
+     LED_MODE_PWM,          // Green brightness = exact, red brightness = approx, together
+     LED_MODE_PULSE         // Short pulses, green per exact and red per approx in parallel
+ } LedMode;
+
+ extern LedMode ledMode;
+
+ // Function prototypes for LED feedback
+ int ledModeParse(const char* name);
+ void ledShowScore(int exact, int approx, int length);
+ void ledSignalNextRound(void);
+
+ #endif // MM_LED_H
@@ -0,0 +1,205 @@
+/*
+  Load generator for the MasterMind game server (mastermind -D <socket>)
+
+$ make mm-loadgen
+$ ./mastermind -D /tmp/mastermind.sock &
+$ ./mm-loadgen -S /tmp/mastermind.sock -c 4 -w 64 -n 100000
+
+  Each thread opens one connection and keeps a window of sessions in flight,
+  pipelining one request per session per round. Reports sessions/sec and the
+  request latency distribution.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "mm-proto.h"
+#include "mm-trace.h"
+#include "mm-rng.h"
+
+#define MAX_WINDOW 256
+
+typedef struct {
+  pthread_t thread;
+  int id;
+  Rng rng;                     // this thread's stream, split from the -s seed
+  int quota;                   // sessions this thread plays
+  int completed;
+  unsigned long long requests;
+  int failed;
+} Worker;
+
+static const char *sockPath = "/tmp/mastermind.sock";
+static int window = 64;
+static TraceHistogram latency;
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int writeAll(int fd, const void *buf, size_t len) {
+  const char *p = buf;
+  while (len > 0) {
+    ssize_t n = write(fd, p, len);
+    if (n <= 0) return 0;
+    p += n;
+    len -= n;
+  }
+  return 1;
+}
+
+static int readAll(int fd, void *buf, size_t len) {
+  char *p = buf;
+  while (len > 0) {
+    ssize_t n = read(fd, p, len);
+    if (n <= 0) return 0;
+    p += n;
+    len -= n;
+  }
+  return 1;
+}
+
+static void *workerMain(void *arg) {
+  Worker *w = arg;
+  MMRequest req[MAX_WINDOW];
+  MMReply rep[MAX_WINDOW];
+  uint32_t session[MAX_WINDOW] = { 0 };
+  uint64_t sent[MAX_WINDOW];
+  int started = 0, pegs = MM_PROTO_MAX_PEGS, colors = 1;
+  struct sockaddr_un addr;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, sockPath, sizeof(addr.sun_path) - 1);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    perror("connect");
+    w->failed = 1;
+    return NULL;
+  }
+
+  while (w->completed < w->quota) {
+    int n = 0;
+    for (int i = 0; i < window; i++) {
+      if (session[i] == 0 && started >= w->quota) continue;
+      memset(&req[n], 0, sizeof(MMRequest));
+      req[n].tag = i;
+      if (session[i] == 0) {
+        req[n].op = MM_OP_NEW;
+        started++;
+        session[i] = UINT32_MAX; // NEW in flight
+      } else {
+        req[n].op = MM_OP_GUESS;
+        req[n].session = session[i];
+        for (int j = 0; j < pegs; j++)
+          req[n].guess[j] = rngBounded(&w->rng, colors) + 1;
+      }
+      sent[i] = nowNs();
+      n++;
+    }
+    if (n == 0) break;
+
+    if (!writeAll(fd, req, n * sizeof(MMRequest)) ||
+        !readAll(fd, rep, n * sizeof(MMReply))) {
+      fprintf(stderr, "Worker %d: connection lost\n", w->id);
+      w->failed = 1;
+      break;
+    }
+    uint64_t now = nowNs();
+    w->requests += n;
+
+    for (int k = 0; k < n; k++) {
+      int i = rep[k].tag;
+      histRecord(&latency, now - sent[i]);
+      if (rep[k].status != MM_OK) {
+        // Pool full or session gone: count it as played and move on
+        session[i] = 0;
+        w->completed++;
+        continue;
+      }
+      if (rep[k].op == MM_OP_NEW) {
+        session[i] = rep[k].session;
+        pegs = rep[k].exact;
+        colors = rep[k].approx;
+      } else if (rep[k].done) {
+        session[i] = 0;
+        w->completed++;
+      }
+    }
+  }
+  close(fd);
+  return NULL;
+}
+
+int main (int argc, char **argv) {
+  int threads = 4, sessions = 10000;
+  unsigned long long seed = 1701;
+  int opt;
+  Rng base;
+
+  while ((opt = getopt(argc, argv, "S:c:w:n:s:")) != -1) {
+    switch (opt) {
+    case 'S':
+      sockPath = optarg;
+      break;
+    case 'c':
+      threads = atoi(optarg);
+      break;
+    case 'w':
+      window = atoi(optarg);
+      break;
+    case 'n':
+      sessions = atoi(optarg);
+      break;
+    case 's':
+      seed = strtoull(optarg, NULL, 10);
+      break;
+    default: /* '?' */
+      fprintf(stderr, "Usage: %s [-S <socket>] [-c <connections>] [-w <window>] [-n <sessions>] [-s <seed>]\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (threads < 1) threads = 1;
+  if (window < 1 || window > MAX_WINDOW) window = MAX_WINDOW;
+
+  Worker *workers = calloc(threads, sizeof(Worker));
+  Rng *streams = calloc(threads, sizeof(Rng));
+  rngSeed(&base, seed);
+  rngSplit(&base, streams, threads);
+  uint64_t t1 = nowNs();
+  for (int i = 0; i < threads; i++) {
+    workers[i].id = i;
+    workers[i].rng = streams[i];
+    workers[i].quota = sessions / threads + (i < sessions % threads);
+    pthread_create(&workers[i].thread, NULL, workerMain, &workers[i]);
+  }
+
+  int completed = 0, failed = 0;
+  unsigned long long requests = 0;
+  for (int i = 0; i < threads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    completed += workers[i].completed;
+    requests += workers[i].requests;
+    failed |= workers[i].failed;
+  }
+  double secs = (nowNs() - t1) / 1e9;
+
+  fprintf(stdout, "%d sessions, %llu requests in %.3f s\n", completed, requests, secs);
+  fprintf(stdout, "%.0f sessions/s, %.0f requests/s\n", completed / secs, requests / secs);
+  fprintf(stdout, "latency (us): p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+          histPercentile(&latency, 0.50) / 1000.0,
+          histPercentile(&latency, 0.99) / 1000.0,
+          histPercentile(&latency, 0.999) / 1000.0,
+          latency.max / 1000.0);
+  free(workers);
+  free(streams);
+  return failed ? 1 : 0;
+}
@@ -6,7 +6,9 @@
  * approximate matches (same color, different position)
  */
 
+.text
 .global matchesASM
+.type matchesASM, %function
 
 /*
  * Function: matchesASM
@@ -32,11 +34,12 @@ matchesASM:
     
     @ Initialize used arrays to 0
     mov r8, #0              @ Loop counter
+    mov r11, #0             @ r11 = 0 (str takes a register, not an immediate)
 init_loop:
     cmp r8, r2
     beq init_done
-    str #0, [r6, r8, lsl #2]
-    str #0, [r7, r8, lsl #2]
+    str r11, [r6, r8, lsl #2]
+    str r11, [r7, r8, lsl #2]
     add r8, r8, #1
     b init_loop
 init_done:
@@ -123,13 +126,15 @@ approx_done:
     @ Store exact matches result
     str r4, [r3]
     
-    @ Load pointer to approximate matches from stack
-    ldr r3, [sp, #(r2, lsl #3)]  @ Offset by 2*length*4 + original sp
+    @ Clean up stack
+    add sp, sp, r2, lsl #3  @ Deallocate both arrays (2*length*4 bytes)
+    
+    @ Load pointer to approximate matches from stack, above the 9 saved registers
+    ldr r3, [sp, #36]
     
     @ Store approximate matches result
     str r5, [r3]
     
-    @ Clean up stack
-    add sp, sp, r2, lsl #3  @ Deallocate both arrays (2*length*4 bytes)
-    
+    @ Return the exact matches
+    mov r0, r4
     pop {r4-r11, pc}        @ Restore registers and return
\ No newline at end of file
@@ -0,0 +1,182 @@
+/*
+ * Multi-secret variant: one guess scored against K secrets at once
+ * For F28HS Coursework 2
+ *
+ * In the multi-secret game every guess is scored against all K hidden
+ * secrets (4 to 16). K calls of matchesASM cost K times one call. Here
+ * the secrets are stored transposed: row i holds peg i of every secret,
+ * and row c holds how often colour c occurs in each one. Scoring compares
+ * the guess peg with a whole row and takes min(secret count, guess count)
+ * over a whole row, byte-wise across 16 lanes. Those loops have no
+ * branches and a fixed trip count, so the compiler turns each row into a
+ * single vector operation: SSE2 on a PC, NEON on a Pi 2 or later, where
+ * the Makefile adds -mfpu=neon-vfpv4 for this file (armhf defaults to VFP
+ * only). All 16 lanes are computed whatever K is, so a guess costs the
+ * same for K = 4 as for K = 16, vectorised or not.
+ *
+ * The tournament plays games headless with a simple solver and times the
+ * batched scoring against K matchesASM calls on the same guesses.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include "mm-multi.h"
+ #include "mm-rng.h"
+ #include "mm-score.h"
+
+ extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
+
+ // Transpose count secrets of length pegs; returns 0 if the board does not fit
+ int multiLoad(MultiSecrets* m, const int* secrets, int count, int length, int colors) {
+     if (count < 1 || count > MULTI_LANES || length > MULTI_MAX_PEGS || colors > MULTI_MAX_COLORS) {
+         fprintf(stderr, "Multi-secret: at most %d secrets of %d pegs, %d colours\n",
+                 MULTI_LANES, MULTI_MAX_PEGS, MULTI_MAX_COLORS);
+         return 0;
+     }
+     
+     // Unused lanes keep colour 0, which no guess has
+     memset(m, 0, sizeof(MultiSecrets));
+     m->count = count;
+     m->length = length;
+     m->colors = colors;
+     for (int j = 0; j < count; j++) {
+         for (int i = 0; i < length; i++) {
+             int c = secrets[j * length + i];
+             m->pegs[i][j] = c;
+             m->hist[c][j]++;
+         }
+     }
+     return 1;
+ }
+
+ // Exact and approximate matches of guess against every secret (MULTI_LANES
+ // bytes each, the lanes after m->count are meaningless)
+ void multiScore(const MultiSecrets* m, const int* guess, uint8_t* restrict exact, uint8_t* restrict approx) {
+     uint8_t e[MULTI_LANES] = {0}, total[MULTI_LANES] = {0};
+     uint8_t guessHist[MULTI_MAX_COLORS + 1] = {0};
+     
+     for (int i = 0; i < m->length; i++) {
+         uint8_t g = guess[i];
+         const uint8_t* row = m->pegs[i];
+         guessHist[g]++;
+         for (int j = 0; j < MULTI_LANES; j++) {
+             e[j] += row[j] == g;
+         }
+     }
+     for (int c = 1; c <= m->colors; c++) {
+         uint8_t n = guessHist[c];
+         const uint8_t* row = m->hist[c];
+         for (int j = 0; j < MULTI_LANES; j++) {
+             total[j] += row[j] < n ? row[j] : n;
+         }
+     }
+     for (int j = 0; j < MULTI_LANES; j++) {
+         exact[j] = e[j];
+         approx[j] = total[j] - e[j];
+     }
+ }
+
+ static uint64_t nowNs(void) {
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+ }
+
+ // Play games of count secrets headless and report guesses and scoring time;
+ // returns 0 if the batched scores ever disagree with matchesASM
+ int runTournament(int games, int count, int length, int colors, uint64_t seed) {
+     if (!scoreInit(length, colors)) {
+         fprintf(stderr, "Tournament: the board needs a score table (at most %d codes)\n", SCORE_MAX_CODES);
+         return 0;
+     }
+     int codes = scoreCodes, maxAttempts = 10 + count;
+     int* secrets = malloc(sizeof(int) * count * length);
+     unsigned char* cands = malloc((size_t)count * codes);   // Codes still possible, per secret
+     if (secrets == NULL || cands == NULL) {
+         fprintf(stderr, "Tournament: out of memory\n");
+         free(secrets);
+         free(cands);
+         return 0;
+     }
+
+     Rng rng;
+     rngSeed(&rng, seed);
+     MultiSecrets m;
+     uint64_t batchNs = 0, loopNs = 0;
+     long long guesses = 0, mismatches = 0;
+     int won = 0;
+     volatile int sink = 0;
+
+     for (int game = 0; game < games; game++) {
+         int solved[MULTI_MAX] = {0}, left[MULTI_MAX], numSolved = 0, attempts = 0;
+         rngSecrets(&rng, secrets, count, length, colors);
+         if (!multiLoad(&m, secrets, count, length, colors)) break;
+         memset(cands, 1, (size_t)count * codes);
+         for (int j = 0; j < count; j++) left[j] = codes;
+
+         while (numSolved < count && attempts < maxAttempts) {
+             // Guess the first code still possible for the secret closest to solved
+             int target = -1, guess[MULTI_MAX_PEGS], guessIdx = 0;
+             for (int j = 0; j < count; j++) {
+                 if (!solved[j] && (target < 0 || left[j] < left[target])) target = j;
+             }
+             while (!cands[target * codes + guessIdx]) guessIdx++;
+             codeFromIndex(guessIdx, guess);
+             attempts++;
+             guesses++;
+
+             // The batched scoring, and the same K scores one call at a time
+             uint8_t exact[MULTI_LANES], approx[MULTI_LANES];
+             uint64_t t1 = nowNs();
+             for (int r = 0; r < MULTI_REPEAT; r++) {
+                 multiScore(&m, guess, exact, approx);
+             }
+             uint64_t t2 = nowNs();
+             int e[MULTI_MAX], a[MULTI_MAX];
+             for (int r = 0; r < MULTI_REPEAT; r++) {
+                 for (int j = 0; j < count; j++) {
+                     matchesASM(secrets + j * length, guess, length, &e[j], &a[j]);
+                 }
+             }
+             uint64_t t3 = nowNs();
+             batchNs += t2 - t1;
+             loopNs += t3 - t2;
+             sink += exact[0];
+
+             for (int j = 0; j < count; j++) {
+                 if (exact[j] != e[j] || approx[j] != a[j]) mismatches++;
+                 if (solved[j]) continue;
+                 if (exact[j] == length) {
+                     solved[j] = 1;
+                     numSolved++;
+                     continue;
+                 }
+                 // Keep the codes that would have given the same score
+                 unsigned char s = (exact[j] << 4) | approx[j];
+                 unsigned char* cj = cands + j * codes;
+                 for (int c = 0; c < codes; c++) {
+                     if (cj[c] && scoreLookup(c, guessIdx) != s) {
+                         cj[c] = 0;
+                         left[j]--;
+                     }
+                 }
+             }
+         }
+         if (numSolved == count) won++;
+     }
+
+     double perGuess = (double)MULTI_REPEAT * (guesses > 0 ? guesses : 1);
+     printf("Tournament: %d games, %d secrets of %d pegs x %d colours\n", games, count, length, colors);
+     printf("  won %d (%.1f%%) within %d attempts, %.2f guesses/game\n", won,
+            games > 0 ? 100.0 * won / games : 0.0, maxAttempts, games > 0 ? (double)guesses / games : 0.0);
+     printf("  batched scoring    %7.1f ns/guess\n", batchNs / perGuess);
+     printf("  %2d x matchesASM    %7.1f ns/guess (%.1fx)\n", count, loopNs / perGuess,
+            batchNs > 0 ? (double)loopNs / batchNs : 0.0);
+     if (mismatches > 0) printf("  %lld scores differ from matchesASM\n", mismatches);
+
+     free(secrets);
+     free(cands);
+     return mismatches == 0;
+ }
@@ -0,0 +1,31 @@
+/*
+ * Multi-secret variant: one guess scored against K secrets at once
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_MULTI_H
+ #define MM_MULTI_H
+
+ #include <stdint.h>
+
+ #define MULTI_LANES 16         // Secrets scored together: one 128-bit vector of bytes
+ #define MULTI_MAX MULTI_LANES  // Largest K
+ #define MULTI_MAX_PEGS 8
+ #define MULTI_MAX_COLORS 15
+ #define MULTI_REPEAT 64        // Tournament: scorings timed per guess
+
+ // The K secrets in structure-of-arrays form: one row per peg and one per
+ // colour count, each with a byte per secret, so a guess is scored by
+ // length + colours vector operations whatever K is
+ typedef struct {
+     int count, length, colors;
+     uint8_t pegs[MULTI_MAX_PEGS][MULTI_LANES];
+     uint8_t hist[MULTI_MAX_COLORS + 1][MULTI_LANES];
+ } MultiSecrets;
+
+ // Function prototypes for multi-secret scoring
+ int multiLoad(MultiSecrets* m, const int* secrets, int count, int length, int colors);
+ void multiScore(const MultiSecrets* m, const int* guess, uint8_t* restrict exact, uint8_t* restrict approx);
+ int runTournament(int games, int count, int length, int colors, uint64_t seed);
+
+ #endif // MM_MULTI_H
@@ -0,0 +1,237 @@
+/*
+ * Performance counters around hot regions (perf_event_open)
+ * For F28HS Coursework 2
+ *
+ * Wall-clock time says which matcher is faster, not why. Each thread opens
+ * one perf event group (cycles, instructions, branch misses, cache misses,
+ * user space only) and a region reads the whole group once at each end, so
+ * per-region IPC and misses per operation fall out of the differences.
+ * Where the PMU is not available (no PMU driver, a VM, perf_event_paranoid)
+ * the same regions count the kernel's software events instead, and where
+ * perf_event_open is refused outright, thread CPU time (user and kernel,
+ * the clock cannot split them). A thread's group is closed when it exits.
+ *
+ * A read costs a syscall; its user-space part is measured on an empty
+ * region at startup and subtracted, so tiny regions such as digitalWrite
+ * still give sensible numbers.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <unistd.h>
+ #include <pthread.h>
+ #include <sys/syscall.h>
+ #include <linux/perf_event.h>
+ #include "mm-perf.h"
+
+ #define PERF_CALIBRATE_ROUNDS 256
+
+ typedef struct {
+     uint32_t type;
+     uint64_t config;
+     const char* name;
+ } PerfEventDesc;
+
+ static const PerfEventDesc hwEvents[PERF_MAX_EVENTS] = {
+     { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles" },
+     { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instr" },
+     { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "br-miss" },
+     { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache-miss" }
+ };
+
+ static const PerfEventDesc swEvents[PERF_MAX_EVENTS] = {
+     { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, "task-ns" },
+     { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "faults" },
+     { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "switches" },
+     { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "migrations" }
+ };
+
+ static const char* modeNames[] = { "off", "hardware", "software", "thread CPU time" };
+
+ // Global variables
+ int perfEnabled = 0;
+ static PerfMode perfMode = PERF_MODE_OFF;
+ static const PerfEventDesc* perfEvents;
+ static int numEvents;
+ static int eventOpen[PERF_MAX_EVENTS];           // Opened by the thread that ran perfInit
+ static uint64_t overhead[PERF_MAX_EVENTS];       // Cost of an empty region
+ static char regionNames[PERF_MAX_REGIONS][PERF_NAME_LEN] = {
+     "match(game)", "match(unit)", "lcdByte", "digitalWrite"
+ };
+ static int numRegions = PERF_NUM_FIXED;
+ static uint64_t regionCalls[PERF_MAX_REGIONS], regionOps[PERF_MAX_REGIONS];
+ static uint64_t regionSums[PERF_MAX_REGIONS][PERF_MAX_EVENTS];
+
+ // Per thread: the group leader and where each event sits in a group read
+ static __thread int threadState;                 // 0 not opened yet, 1 ready, -1 unusable
+ static __thread int threadFd;
+ static __thread int threadSlot[PERF_MAX_EVENTS];
+ static __thread int threadFds[PERF_MAX_EVENTS];  // Every event opened, closed on thread exit
+ static pthread_key_t threadKey;                  // Its destructor closes them
+
+ static int perfOpen(const PerfEventDesc* ev, int groupFd) {
+     struct perf_event_attr attr;
+     memset(&attr, 0, sizeof(attr));
+     attr.size = sizeof(attr);
+     attr.type = ev->type;
+     attr.config = ev->config;
+     attr.exclude_kernel = 1;
+     attr.exclude_hv = 1;
+     attr.read_format = PERF_FORMAT_GROUP;
+     return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+ }
+
+ // Open this thread's group; events after the leader may be missing
+ static int threadOpen(const PerfEventDesc* events, int* opened) {
+     int slots = 0;
+     threadFd = -1;
+     for (int i = 0; i < PERF_MAX_EVENTS; i++) {
+         int fd = perfOpen(&events[i], threadFd);
+         threadSlot[i] = -1;
+         threadFds[i] = fd;
+         if (fd < 0) {
+             if (i == 0) return 0;
+             continue;
+         }
+         if (i == 0) threadFd = fd;
+         threadSlot[i] = slots++;
+         if (opened != NULL) opened[i] = 1;
+     }
+     return 1;
+ }
+
+ // Key destructor: close the exiting thread's group, members first
+ static void threadClose(void* fds) {
+     int* fd = fds;
+     for (int i = PERF_MAX_EVENTS - 1; i >= 0; i--) {
+         if (fd[i] >= 0) close(fd[i]);
+     }
+ }
+
+ static int threadReady(void) {
+     if (threadState == 0) {
+         threadState = perfMode == PERF_MODE_CLOCK || threadOpen(perfEvents, NULL) ? 1 : -1;
+         if (threadState == 1 && perfMode != PERF_MODE_CLOCK) pthread_setspecific(threadKey, threadFds);
+     }
+     return threadState == 1;
+ }
+
+ // Current counter values of the calling thread
+ static void perfRead(uint64_t* values) {
+     if (perfMode == PERF_MODE_CLOCK) {
+         struct timespec ts;
+         clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+         values[0] = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+         return;
+     }
+     uint64_t buf[1 + PERF_MAX_EVENTS];
+     if (read(threadFd, buf, sizeof(buf)) < (ssize_t)sizeof(uint64_t)) {
+         memset(buf, 0, sizeof(buf));
+     }
+     for (int i = 0; i < numEvents; i++) {
+         values[i] = threadSlot[i] >= 0 && (uint64_t)threadSlot[i] < buf[0] ? buf[1 + threadSlot[i]] : 0;
+     }
+ }
+
+ static void perfAtExit(void) {
+     perfReport(stderr);
+ }
+
+ // Open the best counters available and measure the cost of an empty
+ // region; with report set, print the table when the program exits
+ PerfMode perfInit(int report) {
+     if (threadOpen(hwEvents, eventOpen)) {
+         perfMode = PERF_MODE_HW;
+         perfEvents = hwEvents;
+         numEvents = PERF_MAX_EVENTS;
+     } else if (threadOpen(swEvents, eventOpen)) {
+         perfMode = PERF_MODE_SW;
+         perfEvents = swEvents;
+         numEvents = PERF_MAX_EVENTS;
+     } else {
+         perfMode = PERF_MODE_CLOCK;
+         perfEvents = NULL;
+         numEvents = 1;
+         eventOpen[0] = 1;
+     }
+     threadState = 1;
+     pthread_key_create(&threadKey, threadClose);
+
+     // Smallest cost of an empty region per event
+     for (int i = 0; i < numEvents; i++) {
+         overhead[i] = UINT64_MAX;
+     }
+     for (int r = 0; r < PERF_CALIBRATE_ROUNDS; r++) {
+         uint64_t a[PERF_MAX_EVENTS], b[PERF_MAX_EVENTS];
+         perfRead(a);
+         perfRead(b);
+         for (int i = 0; i < numEvents; i++) {
+             if (b[i] - a[i] < overhead[i]) overhead[i] = b[i] - a[i];
+         }
+     }
+
+     perfEnabled = 1;
+     if (report) atexit(perfAtExit);
+     return perfMode;
+ }
+
+ // Add a named region, returns its id or -1 if the table is full
+ int perfRegion(const char* name) {
+     int id = __atomic_fetch_add(&numRegions, 1, __ATOMIC_RELAXED);
+     if (id >= PERF_MAX_REGIONS) return -1;
+     snprintf(regionNames[id], PERF_NAME_LEN, "%s", name);
+     return id;
+ }
+
+ void perfBegin(PerfMark* mark) {
+     if (threadReady()) perfRead(mark->start);
+ }
+
+ // Close a region that did ops operations (misses are reported per op)
+ void perfEnd(PerfMark* mark, int region, uint64_t ops) {
+     uint64_t now[PERF_MAX_EVENTS];
+     if (region < 0 || region >= PERF_MAX_REGIONS || !threadReady()) return;
+
+     perfRead(now);
+     for (int i = 0; i < numEvents; i++) {
+         uint64_t d = now[i] - mark->start[i];
+         d = d > overhead[i] ? d - overhead[i] : 0;
+         __atomic_fetch_add(&regionSums[region][i], d, __ATOMIC_RELAXED);
+     }
+     __atomic_fetch_add(&regionCalls[region], 1, __ATOMIC_RELAXED);
+     __atomic_fetch_add(&regionOps[region], ops, __ATOMIC_RELAXED);
+ }
+
+ // Print per-op counts for every region that ran
+ void perfReport(FILE* out) {
+     int regions = numRegions < PERF_MAX_REGIONS ? numRegions : PERF_MAX_REGIONS;
+     int ipc = perfMode == PERF_MODE_HW && eventOpen[0] && eventOpen[1];
+
+     fprintf(out, "Perf counters (%s, %s, per op):\n", modeNames[perfMode],
+             perfMode == PERF_MODE_CLOCK ? "user and kernel" : "user space");
+     fprintf(out, "%-16s %10s %12s", "region", "calls", "ops");
+     for (int i = 0; i < numEvents; i++) {
+         fprintf(out, " %11s", perfEvents != NULL ? perfEvents[i].name : "cpu-ns");
+     }
+     fprintf(out, ipc ? " %6s\n" : "\n", "IPC");
+
+     for (int r = 0; r < regions; r++) {
+         if (regionCalls[r] == 0) continue;
+         double ops = (double)regionOps[r];
+         fprintf(out, "%-16s %10llu %12llu", regionNames[r],
+                 (unsigned long long)regionCalls[r], (unsigned long long)regionOps[r]);
+         for (int i = 0; i < numEvents; i++) {
+             if (eventOpen[i]) {
+                 fprintf(out, " %11.2f", regionSums[r][i] / ops);
+             } else {
+                 fprintf(out, " %11s", "-");
+             }
+         }
+         if (ipc) {
+             fprintf(out, " %6.2f", regionSums[r][0] ? (double)regionSums[r][1] / regionSums[r][0] : 0.0);
+         }
+         fprintf(out, "\n");
+     }
+ }
@@ -0,0 +1,51 @@
+/*
+ * Performance counters around hot regions (perf_event_open)
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_PERF_H
+ #define MM_PERF_H
+
+ #include <stdio.h>
+ #include <stdint.h>
+
+ #define PERF_MAX_REGIONS 32
+ #define PERF_MAX_EVENTS 4
+ #define PERF_NAME_LEN 24
+
+ // Regions instrumented in the game; tools add their own with perfRegion
+ typedef enum {
+     PERF_MATCH_GAME = 0,   // matchesASM in the game loop
+     PERF_MATCH_UNIT,       // matchesASM in runUnitTests
+     PERF_LCD_BYTE,         // lcdByte, its digitalWrites and delays included
+     PERF_DIGITAL_WRITE,    // digitalWrite
+     PERF_NUM_FIXED
+ } PerfFixedRegion;
+
+ // What the counters are, best first
+ typedef enum {
+     PERF_MODE_OFF = 0,
+     PERF_MODE_HW,          // cycles, instructions, branch misses, cache misses
+     PERF_MODE_SW,          // kernel software counters: task clock, faults, switches, migrations
+     PERF_MODE_CLOCK        // no perf_event_open at all: thread CPU time
+ } PerfMode;
+
+ // Counter values at the start of a region, kept by the caller so regions nest
+ typedef struct {
+     uint64_t start[PERF_MAX_EVENTS];
+ } PerfMark;
+
+ // Set by perfInit; a region costs one load and a branch when off
+ extern int perfEnabled;
+
+ #define PERF_BEGIN(mark) do { if (perfEnabled) perfBegin(mark); } while (0)
+ #define PERF_END(mark, region) do { if (perfEnabled) perfEnd(mark, region, 1); } while (0)
+
+ // Function prototypes for the counters
+ PerfMode perfInit(int report);
+ int perfRegion(const char* name);
+ void perfBegin(PerfMark* mark);
+ void perfEnd(PerfMark* mark, int region, uint64_t ops);
+ void perfReport(FILE* out);
+
+ #endif // MM_PERF_H
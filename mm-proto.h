@@ -0,0 +1,48 @@
+/*
+ * Binary protocol of the MasterMind game server (Unix domain socket)
+ * For F28HS Coursework 2
+ *
+ * Every message has a fixed size and uses host byte order, since both ends
+ * run on the same machine. Clients may pipeline any number of requests;
+ * replies come back in request order per connection.
+ */
+
+ #ifndef MM_PROTO_H
+ #define MM_PROTO_H
+
+ #include <stdint.h>
+
+ #define MM_PROTO_MAX_PEGS 8
+
+ // Request opcodes
+ #define MM_OP_NEW   1   // Start a session; reply carries pegs/colours in exact/approx
+ #define MM_OP_GUESS 2   // Score guess[] against the session's secret
+ #define MM_OP_CLOSE 3   // Give up a session
+
+ // Reply status codes
+ #define MM_OK          0
+ #define MM_ERR_SESSION 1   // Unknown or finished session
+ #define MM_ERR_FULL    2   // Session pool exhausted
+ #define MM_ERR_BAD     3   // Unknown opcode or bad colours
+
+ typedef struct {
+     uint8_t op;
+     uint8_t pad[3];
+     uint32_t session;                   // Ignored for MM_OP_NEW
+     uint32_t tag;                       // Echoed back, e.g. for latency tracking
+     uint8_t guess[MM_PROTO_MAX_PEGS];   // Colours 1..colours
+ } MMRequest;
+
+ typedef struct {
+     uint8_t op;
+     uint8_t status;
+     uint8_t exact;
+     uint8_t approx;
+     uint32_t session;
+     uint32_t tag;
+     uint16_t attempts;
+     uint8_t done;                       // Session ended (won or out of attempts)
+     uint8_t pad;
+ } MMReply;
+
+ #endif // MM_PROTO_H
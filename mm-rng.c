@@ -0,0 +1,116 @@
+/*
+ * Fast reproducible random number streams (xoshiro128**)
+ * For F28HS Coursework 2
+ *
+ * xoshiro128** keeps 128 bits of state in four 32-bit words, which suits
+ * the 32-bit ARM core of the Pi. Bounded values use Lemire's multiply and
+ * reject method, so there is no modulo bias, and rngJump skips 2^64 values
+ * ahead to give each worker thread its own non-overlapping stream.
+ */
+
+ #include "mm-rng.h"
+
+ static inline uint32_t rotl(uint32_t x, int k) {
+     return (x << k) | (x >> (32 - k));
+ }
+
+ // SplitMix64, used to spread a seed over the whole state
+ static uint64_t splitMix64(uint64_t* x) {
+     uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+     z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+     z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+     return z ^ (z >> 31);
+ }
+
+ // Seed a generator; the same seed always gives the same stream
+ void rngSeed(Rng* r, uint64_t seed) {
+     uint64_t a = splitMix64(&seed);
+     uint64_t b = splitMix64(&seed);
+     r->s[0] = (uint32_t)a;
+     r->s[1] = (uint32_t)(a >> 32);
+     r->s[2] = (uint32_t)b;
+     r->s[3] = (uint32_t)(b >> 32);
+ }
+
+ // Next 32 random bits
+ uint32_t rngNext(Rng* r) {
+     uint32_t* s = r->s;
+     uint32_t result = rotl(s[1] * 5, 7) * 9;
+     uint32_t t = s[1] << 9;
+
+     s[2] ^= s[0];
+     s[3] ^= s[1];
+     s[1] ^= s[2];
+     s[0] ^= s[3];
+     s[2] ^= t;
+     s[3] = rotl(s[3], 11);
+     return result;
+ }
+
+ // Uniform value in [0, n), n > 0
+ uint32_t rngBounded(Rng* r, uint32_t n) {
+     uint64_t m = (uint64_t)rngNext(r) * n;
+     uint32_t low = (uint32_t)m;
+     if (low < n) {
+         uint32_t threshold = -n % n;
+         while (low < threshold) {
+             m = (uint64_t)rngNext(r) * n;
+             low = (uint32_t)m;
+         }
+     }
+     return m >> 32;
+ }
+
+ // Advance the stream by 2^64 values
+ void rngJump(Rng* r) {
+     static const uint32_t jump[4] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+     uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+     for (int i = 0; i < 4; i++) {
+         for (int b = 0; b < 32; b++) {
+             if (jump[i] & (1u << b)) {
+                 s0 ^= r->s[0];
+                 s1 ^= r->s[1];
+                 s2 ^= r->s[2];
+                 s3 ^= r->s[3];
+             }
+             rngNext(r);
+         }
+     }
+     r->s[0] = s0;
+     r->s[1] = s1;
+     r->s[2] = s2;
+     r->s[3] = s3;
+ }
+
+ // Fill streams[0..n-1] with independent streams: base, base+2^64, ...
+ void rngSplit(const Rng* base, Rng* streams, int n) {
+     Rng r = *base;
+     for (int i = 0; i < n; i++) {
+         streams[i] = r;
+         rngJump(&r);
+     }
+ }
+
+ // Generate count secrets of length pegs (colours 1..colors) into out.
+ // When the whole code space fits in 32 bits one draw makes one secret.
+ void rngSecrets(Rng* r, int* out, int count, int length, int colors) {
+     uint64_t codes = 1;
+     for (int i = 0; i < length && codes <= UINT32_MAX; i++) {
+         codes *= colors;
+     }
+
+     for (int k = 0; k < count; k++, out += length) {
+         if (codes <= UINT32_MAX) {
+             uint32_t code = rngBounded(r, (uint32_t)codes);
+             for (int i = length - 1; i >= 0; i--) {
+                 out[i] = code % colors + 1;
+                 code /= colors;
+             }
+         } else {
+             for (int i = 0; i < length; i++) {
+                 out[i] = rngBounded(r, colors) + 1;
+             }
+         }
+     }
+ }
@@ -0,0 +1,24 @@
+/*
+ * Fast reproducible random number streams (xoshiro128**)
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_RNG_H
+ #define MM_RNG_H
+
+ #include <stdint.h>
+
+ // Generator state, one per thread; never share one between threads
+ typedef struct {
+     uint32_t s[4];
+ } Rng;
+
+ // Function prototypes for random numbers
+ void rngSeed(Rng* r, uint64_t seed);
+ uint32_t rngNext(Rng* r);
+ uint32_t rngBounded(Rng* r, uint32_t n);
+ void rngJump(Rng* r);
+ void rngSplit(const Rng* base, Rng* streams, int n);
+ void rngSecrets(Rng* r, int* out, int count, int length, int colors);
+
+ #endif // MM_RNG_H
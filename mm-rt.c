@@ -0,0 +1,121 @@
+/*
+ * Real-time scheduling mode for the I/O thread, and a jitter probe
+ * For F28HS Coursework 2
+ *
+ * The LCD enable pulses and the debounce logic rely on short sleeps, which
+ * a busy scheduler can stretch from microseconds to milliseconds. Real-time
+ * mode runs the calling thread under SCHED_FIFO, locks all memory, pins the
+ * thread to one core (ideally one kept free with isolcpus=) and pre-faults
+ * the stack. Each step is optional: without the privileges the game just
+ * carries on with whatever did take effect.
+ */
+
+ #define _GNU_SOURCE
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <errno.h>
+ #include <time.h>
+ #include <unistd.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <sys/mman.h>
+ #include "mm-rt.h"
+ #include "mm-trace.h"
+
+ // Touch the stack pages we may use later, so they are resident and locked
+ static void prefaultStack(void) {
+     volatile unsigned char stack[RT_STACK_PREFAULT];
+     for (int i = 0; i < RT_STACK_PREFAULT; i += 4096) {
+         stack[i] = 0;
+     }
+     (void)stack[0];
+ }
+
+ // Switch the calling thread to real-time mode; cpu < 0 picks the last core.
+ // Returns the RT_* parts that took effect.
+ int rtEnable(int cpu, int verbose) {
+     int done = 0;
+
+     if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+         done |= RT_LOCKED;
+         prefaultStack();
+     } else if (verbose) {
+         printf("RT: mlockall failed (%s), memory may page\n", strerror(errno));
+     }
+
+     if (cpu < 0) cpu = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+     cpu_set_t set;
+     CPU_ZERO(&set);
+     CPU_SET(cpu, &set);
+     if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+         done |= RT_PINNED;
+     } else if (verbose) {
+         printf("RT: cannot pin to CPU %d\n", cpu);
+     }
+
+     struct sched_param param;
+     memset(&param, 0, sizeof(param));
+     param.sched_priority = RT_PRIORITY;
+     int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+     if (err == 0) {
+         done |= RT_FIFO;
+     } else if (verbose) {
+         printf("RT: SCHED_FIFO unavailable (%s), staying on SCHED_OTHER\n", strerror(err));
+     }
+
+     if (verbose) {
+         printf("RT: fifo %s, locked %s, pinned to CPU %d %s\n",
+                done & RT_FIFO ? "yes" : "no", done & RT_LOCKED ? "yes" : "no",
+                cpu, done & RT_PINNED ? "yes" : "no");
+     }
+     return done;
+ }
+
+ // Attributes for the helper threads the I/O thread creates: SCHED_OTHER on
+ // any online core, rather than inheriting its priority and its one core
+ void rtHelperAttr(pthread_attr_t* attr) {
+     struct sched_param param;
+     cpu_set_t set;
+     int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+     
+     memset(&param, 0, sizeof(param));
+     CPU_ZERO(&set);
+     for (int i = 0; i < cpus && i < CPU_SETSIZE; i++) {
+         CPU_SET(i, &set);
+     }
+     pthread_attr_init(attr);
+     pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+     pthread_attr_setschedpolicy(attr, SCHED_OTHER);
+     pthread_attr_setschedparam(attr, &param);
+     pthread_attr_setaffinity_np(attr, sizeof(set), &set);
+ }
+ 
+ // Measure how late periodic absolute-deadline sleeps wake up, in the
+ // calling thread's current scheduling mode
+ void rtJitterProbe(FILE* out, const char* label, int samples, int periodUs) {
+     static TraceHistogram hist;
+     struct timespec next, now;
+
+     memset(&hist, 0, sizeof(hist));
+     clock_gettime(CLOCK_MONOTONIC, &next);
+     for (int i = 0; i < samples; i++) {
+         next.tv_nsec += periodUs * 1000L;
+         while (next.tv_nsec >= 1000000000L) {
+             next.tv_nsec -= 1000000000L;
+             next.tv_sec++;
+         }
+         clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+         clock_gettime(CLOCK_MONOTONIC, &now);
+
+         long long late = (now.tv_sec - next.tv_sec) * 1000000000LL + (now.tv_nsec - next.tv_nsec);
+         histRecord(&hist, late > 0 ? late : 0);
+     }
+
+     fprintf(out, "Wake-up latency %-8s p50 %8.1f us  p99 %8.1f us  p99.9 %8.1f us  max %8.1f us\n",
+             label,
+             histPercentile(&hist, 0.50) / 1000.0,
+             histPercentile(&hist, 0.99) / 1000.0,
+             histPercentile(&hist, 0.999) / 1000.0,
+             hist.max / 1000.0);
+ }
@@ -0,0 +1,28 @@
+/*
+ * Real-time scheduling mode for the I/O thread, and a jitter probe
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_RT_H
+ #define MM_RT_H
+
+ #include <stdio.h>
+ #include <pthread.h>
+
+ #define RT_PRIORITY 80                  // SCHED_FIFO priority of the I/O thread
+ #define RT_STACK_PREFAULT (256 * 1024)  // Stack touched up front, so it never faults
+ #define RT_PROBE_SAMPLES 2000
+ #define RT_PROBE_PERIOD_US 500
+
+ // Parts of real-time mode that took effect, returned by rtEnable
+ #define RT_FIFO   0x1
+ #define RT_LOCKED 0x2
+ #define RT_PINNED 0x4
+ #define RT_ALL    (RT_FIFO | RT_LOCKED | RT_PINNED)
+
+ // Function prototypes for real-time mode
+ int rtEnable(int cpu, int verbose);
+ void rtHelperAttr(pthread_attr_t* attr);
+ void rtJitterProbe(FILE* out, const char* label, int samples, int periodUs);
+
+ #endif // MM_RT_H
@@ -0,0 +1,68 @@
+/*
+ * Precomputed score table for the matching function
+ * For F28HS Coursework 2
+ *
+ * Small boards have few codes (27 for 3 pegs x 3 colours), so every
+ * secret/guess pair is scored once with matchesASM and later scores are a
+ * single table load.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include "mm-score.h"
+
+ extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
+
+ // Global variables
+ unsigned char* scoreTable = NULL;
+ int scoreLength = 0, scoreColors = 0, scoreCodes = 0;
+
+ // Build the table for a board geometry, returns 0 if it would be too large
+ int scoreInit(int length, int colors) {
+     int codes = 1;
+     for (int i = 0; i < length; i++) {
+         codes *= colors;
+         if (codes > SCORE_MAX_CODES) return 0;
+     }
+
+     scoreLength = length;
+     scoreColors = colors;
+     scoreCodes = codes;
+
+     free(scoreTable);
+     scoreTable = malloc((size_t)codes * codes);
+     if (scoreTable == NULL) return 0;
+
+     int secret[16], guess[16], exact, approx;
+     for (int s = 0; s < codes; s++) {
+         codeFromIndex(s, secret);
+         for (int g = 0; g < codes; g++) {
+             codeFromIndex(g, guess);
+             matchesASM(secret, guess, length, &exact, &approx);
+             scoreTable[s * codes + g] = (exact << 4) | approx;
+         }
+     }
+     return 1;
+ }
+
+ // Index of a code (colours 1..colors) in the code space
+ int codeIndex(const int* code) {
+     int index = 0;
+     for (int i = 0; i < scoreLength; i++) {
+         index = index * scoreColors + (code[i] - 1);
+     }
+     return index;
+ }
+
+ // Inverse of codeIndex
+ void codeFromIndex(int index, int* code) {
+     for (int i = scoreLength - 1; i >= 0; i--) {
+         code[i] = index % scoreColors + 1;
+         index /= scoreColors;
+     }
+ }
+
+ // Packed score of two codes
+ int scoreCode(const int* secret, const int* guess) {
+     return scoreLookup(codeIndex(secret), codeIndex(guess));
+ }
@@ -0,0 +1,31 @@
+/*
+ * Precomputed score table for the matching function
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_SCORE_H
+ #define MM_SCORE_H
+
+ // Largest code space that gets a full secret x guess table (1 MB)
+ #define SCORE_MAX_CODES 1024
+
+ // A score packs exact matches in the high nibble and approximate in the low
+ #define SCORE_EXACT(s) ((s) >> 4)
+ #define SCORE_APPROX(s) ((s) & 0x0F)
+
+ // Table state, valid after scoreInit
+ extern unsigned char* scoreTable;
+ extern int scoreLength, scoreColors, scoreCodes;
+
+ // Function prototypes for scoring
+ int scoreInit(int length, int colors);
+ int codeIndex(const int* code);
+ void codeFromIndex(int index, int* code);
+ int scoreCode(const int* secret, const int* guess);
+
+ // Score of two code indices, table must be built
+ static inline unsigned char scoreLookup(int secretIdx, int guessIdx) {
+     return scoreTable[secretIdx * scoreCodes + guessIdx];
+ }
+
+ #endif // MM_SCORE_H
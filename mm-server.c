@@ -0,0 +1,504 @@
+/*
+ * Concurrent game server over a Unix domain socket
+ * For F28HS Coursework 2
+ *
+ * One epoll loop hosts thousands of independent sessions. Sessions and
+ * connections live in pools carved out of one allocation at startup, and
+ * all guesses that arrive in one epoll round are scored together in a
+ * single batch before the replies go out. Requests are answered in
+ * arrival order, so a client can pipeline freely.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <errno.h>
+ #include <assert.h>
+ #include <signal.h>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <sys/epoll.h>
+ #include "mm-server.h"
+ #include "mm-proto.h"
+ #include "mm-score.h"
+ #include "mm-rng.h"
+ #include "mm-kernels.h"
+
+ #define MAX_EVENTS 256
+ #define CONN_IN_SIZE (64 * sizeof(MMRequest))
+ #define CONN_OUT_SIZE (256 * sizeof(MMReply))
+
+ extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
+
+ typedef struct {
+     uint32_t id;            // Current session id, 0 when free
+     uint32_t nextFree;      // Free list link (pool index)
+     uint32_t ownNext, ownPrev;  // Owner's session list, SERVER_MAX_SESSIONS ends it
+     int owner;              // Connection slot that created it
+     int secretIdx;          // Index into the score table, if there is one
+     uint16_t attempts;
+     uint8_t secret[MM_PROTO_MAX_PEGS];
+ } Session;
+
+ typedef struct Conn {
+     int fd;                 // -1 when free
+     int slot;
+     int inLen, outLen, outOff;
+     int reserved;           // Replies owed for guesses in the pending batch
+     int events;             // Current epoll interest
+     int dead, dirty;
+     uint32_t ownHead;       // Sessions it created, freed when it closes
+     unsigned char in[CONN_IN_SIZE];
+     unsigned char out[CONN_OUT_SIZE];
+ } Conn;
+
+ typedef struct {
+     Conn* conn;
+     Session* session;       // Looked up when the batch is scored
+     MMRequest req;
+     uint8_t exact, approx;
+     uint8_t valid;          // Guess was scored
+ } Pending;
+
+ // Global variables
+ static volatile sig_atomic_t serverStop = 0;
+ static int epfd = -1;
+ static int pegs, colors, attemptLimit, useTable;
+ static MatchKernel kernel;      // Generated scorer when there is no table
+ static Rng serverRng;
+
+ // The pooled arena: sessions, connections and the pending batch
+ static void* arena;
+ static Session* sessions;
+ static uint32_t freeSession;    // Head of the free list, SERVER_MAX_SESSIONS if empty
+ static uint32_t sessionGen = 0;
+ static Conn* conns;
+ static Pending* pending;
+ static int pendingCount;
+ static Conn** dirtyConns;     // Connections to flush in the next pass
+ static Conn** dirtyWalk;      // The pass being walked, swapped with dirtyConns
+ static int dirtyCount;
+
+ // Statistics
+ static unsigned long long statSessions, statGuesses, statBatches;
+
+ static void onSignal(int sig) {
+     serverStop = 1;
+ }
+
+ static int setNonBlocking(int fd) {
+     int flags = fcntl(fd, F_GETFL, 0);
+     return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+ }
+
+ // Carve all pools out of one allocation
+ static int arenaInit(void) {
+     size_t sessionBytes = sizeof(Session) * SERVER_MAX_SESSIONS;
+     size_t connBytes = sizeof(Conn) * SERVER_MAX_CONNS;
+     size_t pendingBytes = sizeof(Pending) * SERVER_MAX_CONNS * (CONN_OUT_SIZE / sizeof(MMReply));
+     size_t dirtyBytes = sizeof(Conn*) * SERVER_MAX_CONNS;
+
+     arena = calloc(1, sessionBytes + connBytes + pendingBytes + 2 * dirtyBytes);
+     if (arena == NULL) return 0;
+
+     sessions = (Session*)arena;
+     conns = (Conn*)((char*)sessions + sessionBytes);
+     pending = (Pending*)((char*)conns + connBytes);
+     dirtyConns = (Conn**)((char*)pending + pendingBytes);
+     dirtyWalk = (Conn**)((char*)dirtyConns + dirtyBytes);
+
+     for (uint32_t i = 0; i < SERVER_MAX_SESSIONS; i++) {
+         sessions[i].nextFree = i + 1;
+     }
+     freeSession = 0;
+     for (int i = 0; i < SERVER_MAX_CONNS; i++) {
+         conns[i].fd = -1;
+         conns[i].slot = i;
+         conns[i].ownHead = SERVER_MAX_SESSIONS;
+     }
+     return 1;
+ }
+
+ static Session* sessionAlloc(int owner) {
+     if (freeSession >= SERVER_MAX_SESSIONS) return NULL;
+     uint32_t idx = freeSession;
+     Session* s = &sessions[idx];
+     freeSession = s->nextFree;
+
+     // Id = generation in the top bits, pool index below, never 0
+     sessionGen = (sessionGen + 1) & 0x7FF;
+     if (sessionGen == 0) sessionGen = 1;
+     s->id = (sessionGen << 20) | idx;
+     s->owner = owner;
+     s->ownPrev = SERVER_MAX_SESSIONS;
+     s->ownNext = conns[owner].ownHead;
+     if (s->ownNext < SERVER_MAX_SESSIONS) sessions[s->ownNext].ownPrev = idx;
+     conns[owner].ownHead = idx;
+     s->attempts = 0;
+
+     int code[MM_PROTO_MAX_PEGS];
+     rngSecrets(&serverRng, code, 1, pegs, colors);
+     for (int i = 0; i < pegs; i++) {
+         s->secret[i] = code[i];
+     }
+     s->secretIdx = useTable ? codeIndex(code) : 0;
+     statSessions++;
+     return s;
+ }
+
+ static void sessionFree(Session* s) {
+     // Unlink from the owner's list, in O(1) whoever ends the session
+     if (s->ownPrev < SERVER_MAX_SESSIONS) {
+         sessions[s->ownPrev].ownNext = s->ownNext;
+     } else {
+         conns[s->owner].ownHead = s->ownNext;
+     }
+     if (s->ownNext < SERVER_MAX_SESSIONS) sessions[s->ownNext].ownPrev = s->ownPrev;
+     s->id = 0;
+     s->nextFree = freeSession;
+     freeSession = s - sessions;
+ }
+
+ static Session* sessionFind(uint32_t id) {
+     uint32_t idx = id & 0xFFFFF;
+     if (id == 0 || idx >= SERVER_MAX_SESSIONS || sessions[idx].id != id) return NULL;
+     return &sessions[idx];
+ }
+
+ // Each connection is queued at most once per pass, the flag sees to that
+ static void markDirty(Conn* c) {
+     if (!c->dirty) {
+         assert(dirtyCount < SERVER_MAX_CONNS);
+         c->dirty = 1;
+         dirtyConns[dirtyCount++] = c;
+     }
+ }
+
+ static void connReply(Conn* c, const MMReply* r) {
+     memcpy(c->out + c->outLen, r, sizeof(MMReply));
+     c->outLen += sizeof(MMReply);
+     markDirty(c);
+ }
+
+ // Keep epoll interest in step with the buffers: stop reading while the
+ // output buffer cannot take more replies, watch for writability while
+ // output is queued
+ static void connUpdateEvents(Conn* c) {
+     int want = 0;
+     if (c->outLen + (c->reserved + 1) * (int)sizeof(MMReply) <= (int)CONN_OUT_SIZE) want |= EPOLLIN;
+     if (c->outOff < c->outLen) want |= EPOLLOUT;
+     if (want != c->events) {
+         struct epoll_event ev = { .events = want, .data.ptr = c };
+         epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+         c->events = want;
+     }
+ }
+
+ static void connClose(Conn* c) {
+     // Drop the sessions this client left behind
+     while (c->ownHead < SERVER_MAX_SESSIONS) {
+         sessionFree(&sessions[c->ownHead]);
+     }
+     epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+     close(c->fd);
+     c->fd = -1;
+ }
+
+ static void connAccept(int listenFd) {
+     for (;;) {
+         int fd = accept(listenFd, NULL, NULL);
+         if (fd < 0) return;
+
+         Conn* c = NULL;
+         for (int i = 0; i < SERVER_MAX_CONNS; i++) {
+             if (conns[i].fd < 0) {
+                 c = &conns[i];
+                 break;
+             }
+         }
+         if (c == NULL || !setNonBlocking(fd)) {
+             close(fd);
+             continue;
+         }
+
+         c->fd = fd;
+         c->inLen = c->outLen = c->outOff = c->reserved = 0;
+         c->dead = c->dirty = 0;
+         c->events = EPOLLIN;
+         struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+         if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+             close(fd);
+             c->fd = -1;
+         }
+     }
+ }
+
+ // Queue a request for the next batch, replies are owed in this order
+ static void queueRequest(Conn* c, const MMRequest* req) {
+     Pending* p = &pending[pendingCount++];
+     p->conn = c;
+     p->req = *req;
+     p->valid = 0;
+     c->reserved++;
+ }
+
+ // Parse the buffered requests we have reply space for
+ static void connProcess(Conn* c) {
+     int off = 0;
+     while (c->inLen - off >= (int)sizeof(MMRequest) &&
+            c->outLen + (c->reserved + 1) * (int)sizeof(MMReply) <= (int)CONN_OUT_SIZE) {
+         MMRequest req;
+         memcpy(&req, c->in + off, sizeof(req));
+         queueRequest(c, &req);
+         off += sizeof(MMRequest);
+     }
+     memmove(c->in, c->in + off, c->inLen - off);
+     c->inLen -= off;
+     markDirty(c);
+ }
+
+ static void connRead(Conn* c) {
+     for (;;) {
+         ssize_t n = read(c->fd, c->in + c->inLen, CONN_IN_SIZE - c->inLen);
+         if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+             c->dead = 1;
+             markDirty(c);
+             return;
+         }
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             return;
+         }
+         c->inLen += n;
+         connProcess(c);
+
+         // Output full: connUpdateEvents pauses reading until it drains
+         if (c->inLen == (int)CONN_IN_SIZE) return;
+     }
+ }
+
+ // Answer one queued request, guesses were already scored
+ static void answerRequest(Pending* p) {
+     Conn* c = p->conn;
+     MMReply r;
+     memset(&r, 0, sizeof(r));
+     r.op = p->req.op;
+     r.tag = p->req.tag;
+     r.session = p->req.session;
+
+     switch (p->req.op) {
+         case MM_OP_NEW: {
+             Session* s = sessionAlloc(c->slot);
+             if (s == NULL) {
+                 r.status = MM_ERR_FULL;
+             } else {
+                 r.session = s->id;
+                 r.exact = pegs;
+                 r.approx = colors;
+             }
+             break;
+         }
+         case MM_OP_GUESS: {
+             Session* s = p->session;
+             // The session may have ended earlier in this batch
+             if (s == NULL || s->id != p->req.session) {
+                 r.status = MM_ERR_SESSION;
+             } else if (!p->valid) {
+                 r.status = MM_ERR_BAD;
+             } else {
+                 r.exact = p->exact;
+                 r.approx = p->approx;
+                 r.attempts = ++s->attempts;
+                 r.done = p->exact == pegs || s->attempts >= attemptLimit;
+                 if (r.done) sessionFree(s);
+             }
+             break;
+         }
+         case MM_OP_CLOSE: {
+             Session* s = sessionFind(p->req.session);
+             if (s == NULL) {
+                 r.status = MM_ERR_SESSION;
+             } else {
+                 r.attempts = s->attempts;
+                 r.done = 1;
+                 sessionFree(s);
+             }
+             break;
+         }
+         default:
+             r.status = MM_ERR_BAD;
+             break;
+     }
+
+     c->reserved--;
+     if (c->dead) {
+         markDirty(c); // So it gets closed once nothing is owed
+     } else {
+         connReply(c, &r);
+     }
+ }
+
+ // Score every guess of this epoll round in one pass, then answer all
+ // requests in arrival order
+ static void scorePending(void) {
+     if (pendingCount == 0) return;
+     statBatches++;
+
+     for (int i = 0; i < pendingCount; i++) {
+         Pending* p = &pending[i];
+         if (p->req.op != MM_OP_GUESS) continue;
+
+         Session* s = sessionFind(p->req.session);
+         int secret[MM_PROTO_MAX_PEGS], guess[MM_PROTO_MAX_PEGS];
+         int exact, approx, ok = 1;
+
+         p->session = s;
+         if (s == NULL) continue;
+         for (int j = 0; j < pegs; j++) {
+             guess[j] = p->req.guess[j];
+             ok &= guess[j] >= 1 && guess[j] <= colors;
+         }
+         if (!ok) continue;
+
+         if (useTable) {
+             unsigned char sc = scoreLookup(s->secretIdx, codeIndex(guess));
+             exact = SCORE_EXACT(sc);
+             approx = SCORE_APPROX(sc);
+         } else {
+             for (int j = 0; j < pegs; j++) {
+                 secret[j] = s->secret[j];
+             }
+             if (kernel != NULL) {
+                 kernel(secret, guess, &exact, &approx);
+             } else {
+                 matchesASM(secret, guess, pegs, &exact, &approx);
+             }
+         }
+         p->exact = exact;
+         p->approx = approx;
+         p->valid = 1;
+         statGuesses++;
+     }
+
+     for (int i = 0; i < pendingCount; i++) {
+         answerRequest(&pending[i]);
+     }
+     pendingCount = 0;
+ }
+
+ static void connFlush(Conn* c) {
+     while (c->outOff < c->outLen) {
+         ssize_t n = write(c->fd, c->out + c->outOff, c->outLen - c->outOff);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             if (errno != EAGAIN) c->dead = 1;
+             break;
+         }
+         c->outOff += n;
+     }
+     if (c->outOff == c->outLen) {
+         c->outOff = c->outLen = 0;
+     }
+ }
+
+ // Serve games on a Unix domain socket until SIGINT/SIGTERM
+ int runServer(const char* path, int length, int colorCount, int maxAttempts, uint64_t seed) {
+     struct sockaddr_un addr;
+     struct epoll_event events[MAX_EVENTS];
+
+     if (length > MM_PROTO_MAX_PEGS || strlen(path) >= sizeof(addr.sun_path)) {
+         fprintf(stderr, "Bad server configuration\n");
+         return 0;
+     }
+     pegs = length;
+     colors = colorCount;
+     attemptLimit = maxAttempts;
+     useTable = scoreInit(length, colorCount);
+     kernel = useTable ? NULL : findKernel(length, colorCount);
+     rngSeed(&serverRng, seed);
+
+     if (!arenaInit()) {
+         fprintf(stderr, "Failed to allocate session pool\n");
+         return 0;
+     }
+
+     int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+     memset(&addr, 0, sizeof(addr));
+     addr.sun_family = AF_UNIX;
+     strcpy(addr.sun_path, path);
+     unlink(path);
+     if (listenFd < 0 || bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+         listen(listenFd, 128) < 0 || !setNonBlocking(listenFd)) {
+         perror("Failed to listen on socket");
+         return 0;
+     }
+
+     epfd = epoll_create1(0);
+     struct epoll_event lev = { .events = EPOLLIN, .data.ptr = NULL };
+     if (epfd < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, listenFd, &lev) < 0) {
+         perror("Failed to set up epoll");
+         return 0;
+     }
+
+     signal(SIGINT, onSignal);
+     signal(SIGTERM, onSignal);
+     signal(SIGPIPE, SIG_IGN);
+     fprintf(stderr, "Serving %dx%d games on %s\n", pegs, colors, path);
+
+     while (!serverStop) {
+         // Don't block while requests freed up by the last flush are queued
+         int n = epoll_wait(epfd, events, MAX_EVENTS, pendingCount > 0 ? 0 : -1);
+         if (n < 0) {
+             if (errno == EINTR) continue;
+             perror("epoll_wait");
+             break;
+         }
+
+         for (int i = 0; i < n; i++) {
+             Conn* c = events[i].data.ptr;
+             if (c == NULL) {
+                 connAccept(listenFd);
+                 continue;
+             }
+             if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) connRead(c);
+             if (events[i].events & EPOLLOUT) markDirty(c);
+         }
+
+         scorePending();
+
+         // Walk a snapshot: connProcess below marks its connection dirty
+         // again, and that belongs to the next pass, not this one
+         Conn** walk = dirtyConns;
+         int walkCount = dirtyCount;
+         dirtyConns = dirtyWalk;
+         dirtyWalk = walk;
+         dirtyCount = 0;
+         for (int i = 0; i < walkCount; i++) {
+             Conn* c = walk[i];
+             c->dirty = 0;
+             if (!c->dead) connFlush(c);
+             if (c->dead) {
+                 if (c->reserved == 0) connClose(c);
+                 continue;
+             }
+             // Requests held back while the output was full
+             if (c->inLen >= (int)sizeof(MMRequest) && c->outLen == 0) connProcess(c);
+             connUpdateEvents(c);
+         }
+     }
+
+     fprintf(stderr, "Server: %llu sessions, %llu guesses in %llu batches (%.1f per batch)\n",
+             statSessions, statGuesses, statBatches,
+             statBatches ? (double)statGuesses / statBatches : 0.0);
+
+     for (int i = 0; i < SERVER_MAX_CONNS; i++) {
+         if (conns[i].fd >= 0) close(conns[i].fd);
+     }
+     close(listenFd);
+     close(epfd);
+     unlink(path);
+     free(arena);
+     return 1;
+ }
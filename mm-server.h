@@ -0,0 +1,18 @@
+/*
+ * Concurrent game server over a Unix domain socket
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_SERVER_H
+ #define MM_SERVER_H
+
+ #include <stdint.h>
+
+ // Default limits for the session pool
+ #define SERVER_MAX_SESSIONS 65536
+ #define SERVER_MAX_CONNS 1024
+
+ // Function prototypes for the server
+ int runServer(const char* path, int length, int colors, int maxAttempts, uint64_t seed);
+
+ #endif // MM_SERVER_H
@@ -0,0 +1,124 @@
+/*
+ * Shared-memory snapshot of the live game state, guarded by a seqlock
+ * For F28HS Coursework 2
+ *
+ * The game is the only writer. It bumps seq to an odd value, updates the
+ * record and bumps seq again, so an update costs a few stores and no
+ * syscalls. Readers map the record read-only and retry a copy until they
+ * see the same even seq before and after it; they never block the game.
+ */
+
+ #include <stdio.h>
+ #include <string.h>
+ #include <time.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <sys/mman.h>
+ #include "mm-shm.h"
+
+ // Global variables
+ static ShmState* shmState = NULL;   // NULL: publishing is off
+ static const IoCounters* shmIo;     // Copied into the record on every update
+
+ static uint64_t shmNow(void) {
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+ }
+
+ // Writer side of the seqlock
+ static void shmBegin(void) {
+     __atomic_store_n(&shmState->seq, shmState->seq + 1, __ATOMIC_RELAXED);
+     __atomic_thread_fence(__ATOMIC_RELEASE);
+ }
+
+ static void shmEnd(void) {
+     shmState->updateNs = shmNow();
+     shmState->gpioWrites = shmIo->gpioWrites;
+     shmState->lcdBytes = shmIo->lcdBytes;
+     shmState->buttonReads = shmIo->buttonReads;
+     __atomic_store_n(&shmState->seq, shmState->seq + 1, __ATOMIC_RELEASE);
+ }
+
+ // Create and map the state record, returns 0 (and stays off) on failure
+ int shmPublishInit(int codeLength, int maxAttempts, const IoCounters* io) {
+     int fd = shm_open(SHM_STATE_NAME, O_CREAT | O_RDWR, 0644);
+     if (fd < 0) return 0;
+     if (ftruncate(fd, sizeof(ShmState)) < 0) {
+         close(fd);
+         return 0;
+     }
+     void* p = mmap(NULL, sizeof(ShmState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+     close(fd);
+     if (p == MAP_FAILED) return 0;
+
+     shmState = (ShmState*)p;
+     shmIo = io;
+     shmBegin();
+     uint32_t seq = shmState->seq;
+     memset(shmState, 0, sizeof(ShmState));
+     shmState->seq = seq;            // Keep readers' retry logic intact
+     shmState->magic = SHM_STATE_MAGIC;
+     shmState->version = SHM_STATE_VERSION;
+     shmState->codeLength = codeLength < SHM_MAX_PEGS ? codeLength : SHM_MAX_PEGS;
+     shmState->maxAttempts = maxAttempts;
+     shmState->startNs = shmNow();
+     shmEnd();
+     return 1;
+ }
+
+ void shmSetPhase(int phase) {
+     if (shmState == NULL) return;
+     shmBegin();
+     shmState->phase = phase;
+     shmEnd();
+ }
+
+ // A new attempt starts with an empty guess
+ void shmSetAttempt(int attempt) {
+     if (shmState == NULL) return;
+     shmBegin();
+     shmState->attempt = attempt;
+     shmState->digit = 0;
+     shmState->phase = SHM_PHASE_INPUT;
+     memset(shmState->guess, 0, sizeof(shmState->guess));
+     shmEnd();
+ }
+
+ void shmSetDigit(int digit, int value) {
+     if (shmState == NULL || digit >= SHM_MAX_PEGS) return;
+     shmBegin();
+     shmState->digit = digit;
+     shmState->guess[digit] = value;
+     shmEnd();
+ }
+
+ void shmSetScore(int exact, int approx) {
+     if (shmState == NULL) return;
+     shmBegin();
+     shmState->lastExact = exact;
+     shmState->lastApprox = approx;
+     shmState->phase = SHM_PHASE_SCORING;
+     shmEnd();
+ }
+
+ // Map the record read-only, NULL if no game has published one
+ const volatile ShmState* shmAttach(void) {
+     int fd = shm_open(SHM_STATE_NAME, O_RDONLY, 0);
+     if (fd < 0) return NULL;
+     void* p = mmap(NULL, sizeof(ShmState), PROT_READ, MAP_SHARED, fd, 0);
+     close(fd);
+     return p == MAP_FAILED ? NULL : (const volatile ShmState*)p;
+ }
+
+ // Take a consistent copy of the record, returns 0 if it is not a state record
+ int shmSnapshot(const volatile ShmState* src, ShmState* out) {
+     for (;;) {
+         uint32_t before = __atomic_load_n(&src->seq, __ATOMIC_ACQUIRE);
+         if (before & 1) continue; // Writer is mid-update
+         memcpy(out, (const void*)src, sizeof(ShmState));
+         __atomic_thread_fence(__ATOMIC_ACQUIRE);
+         if (__atomic_load_n(&src->seq, __ATOMIC_RELAXED) == before) break;
+     }
+     return out->magic == SHM_STATE_MAGIC && out->version == SHM_STATE_VERSION;
+ }
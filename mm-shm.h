@@ -0,0 +1,55 @@
+/*
+ * Shared-memory snapshot of the live game state, guarded by a seqlock
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_SHM_H
+ #define MM_SHM_H
+
+ #include <stdint.h>
+ #include "lcdBinary.h"
+
+ #define SHM_STATE_NAME "/mastermind-state"  // Appears as /dev/shm/mastermind-state
+ #define SHM_STATE_MAGIC 0x4D4D5354          // "MMST"
+ #define SHM_STATE_VERSION 1
+ #define SHM_MAX_PEGS 8
+
+ // Game phases
+ #define SHM_PHASE_START    0
+ #define SHM_PHASE_INPUT    1
+ #define SHM_PHASE_SCORING  2
+ #define SHM_PHASE_WON      3
+ #define SHM_PHASE_LOST     4
+
+ // Fixed-layout record; seq is odd while the game is updating it
+ typedef struct {
+     uint32_t magic;
+     uint32_t version;
+     uint32_t seq;
+     int32_t phase;
+     int32_t attempt;                // 1-based, 0 before the first guess
+     int32_t maxAttempts;
+     int32_t codeLength;
+     int32_t digit;                  // Index of the digit being entered
+     int32_t guess[SHM_MAX_PEGS];    // Partial guess, 0 = not entered yet
+     int32_t lastExact;
+     int32_t lastApprox;
+     uint64_t startNs;               // CLOCK_MONOTONIC
+     uint64_t updateNs;
+     uint64_t gpioWrites;
+     uint64_t lcdBytes;
+     uint64_t buttonReads;
+ } ShmState;
+
+ // Function prototypes for the writer (the game)
+ int shmPublishInit(int codeLength, int maxAttempts, const IoCounters* io);
+ void shmSetPhase(int phase);
+ void shmSetAttempt(int attempt);
+ void shmSetDigit(int digit, int value);
+ void shmSetScore(int exact, int approx);
+
+ // Function prototypes for readers
+ const volatile ShmState* shmAttach(void);
+ int shmSnapshot(const volatile ShmState* src, ShmState* out);
+
+ #endif // MM_SHM_H
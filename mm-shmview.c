@@ -0,0 +1,59 @@
+/*
+  Reader for the live game state published by mastermind in /dev/shm
+
+$ make mm-shmview
+$ ./mm-shmview          # refresh every 200ms
+$ ./mm-shmview -1       # print one snapshot and exit
+
+  Reads go through the seqlock in mm-shm.c: no syscalls after the initial
+  mmap, and the game is never blocked.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "mm-shm.h"
+
+static const char *phaseNames[] = { "start", "input", "scoring", "won", "lost" };
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void showState(const ShmState *st) {
+  printf("phase %-7s attempt %d/%d  guess ",
+         st->phase >= 0 && st->phase <= SHM_PHASE_LOST ? phaseNames[st->phase] : "?",
+         st->attempt, st->maxAttempts);
+  for (int i = 0; i < st->codeLength; i++)
+    printf("%c", st->guess[i] ? '0' + st->guess[i] : '_');
+  printf("  last E:%d A:%d  up %.1fs, updated %.1fs ago  gpio %llu lcd %llu btn %llu\n",
+         st->lastExact, st->lastApprox,
+         (st->updateNs - st->startNs) / 1e9, (nowNs() - st->updateNs) / 1e9,
+         (unsigned long long)st->gpioWrites, (unsigned long long)st->lcdBytes,
+         (unsigned long long)st->buttonReads);
+}
+
+int main (int argc, char **argv) {
+  int once = argc > 1 && argv[1][0] == '-' && argv[1][1] == '1';
+  const volatile ShmState *src = shmAttach();
+  ShmState st;
+
+  if (src == NULL) {
+    fprintf(stderr, "No game state in /dev/shm%s (is mastermind running?)\n", SHM_STATE_NAME);
+    exit(EXIT_FAILURE);
+  }
+  do {
+    if (!shmSnapshot(src, &st)) {
+      fprintf(stderr, "Unknown state record layout\n");
+      exit(EXIT_FAILURE);
+    }
+    showState(&st);
+    if (!once)
+      usleep(200000);
+  } while (!once);
+  return 0;
+}
@@ -0,0 +1,406 @@
+/*
+ * Simulated GPIO backend with scripted button input
+ * For F28HS Coursework 2
+ *
+ * Linked instead of the register-level functions of lcdBinary.c (which is
+ * compiled with -DLCD_SIM), so the real game and LCD driver run unchanged.
+ * Button presses come from a script, the LCD is decoded at the pin level
+ * (4-bit bus, latched on the falling edge of EN), and the latency from
+ * every press to the next LED and LCD output is written out as JSON.
+ *
+ * Time comes from the game clock, so with -V (virtual time) a whole game
+ * runs in milliseconds. Either way the LCD bus is checked against the
+ * HD44780 timing contract: EN pulse width and cycle time, and the
+ * execution time of each instruction (37 us, 1.52 ms for clear and home,
+ * 4.1 ms/100 us for the 8-bit wake-up writes) before the next EN pulse.
+ *
+ * Environment:
+ *   MM_SIM_SCRIPT  press script, one "<delay_ms> <hold_ms>" per line; the
+ *                  delay counts from the release of the previous press
+ *   MM_SIM_REPLAY  GPIO trace (mastermind -g) whose button waveform, bounce
+ *                  and all, is replayed instead of a script; its time 0 is
+ *                  the end of initGPIO, as in the capture
+ *   MM_SIM_JSON    where to write the results (default: stderr)
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include "lcdBinary.h"
+ #include "mm-gtrace.h"
+ #include "mm-clock.h"
+
+ #define SIM_MAX_PRESSES 1024
+ #define SIM_REPLAY_SETTLE_MS 20    // Low this long before a rising edge = new press
+
+ // HD44780 timing (us)
+ #define LCD_EN_HIGH_MIN 0.45
+ #define LCD_EN_CYCLE_MIN 1.0
+ #define LCD_EXEC_US 37.0
+ #define LCD_EXEC_LONG_US 1520.0    // Clear display, return home
+ #define LCD_COLS 40
+
+ typedef struct {
+     double delayMs, holdMs;     // From the script
+     double startUs;             // When the press actually started
+     double ledUs, lcdUs;        // First output after it, -1 if none
+ } SimPress;
+
+ // Global variables
+ static SimPress presses[SIM_MAX_PRESSES];
+ static int pressCount = 0;
+ static int pressIndex = 0;      // Next (or current) press
+ static double pressEnd = 0;     // End of the previous press
+ static double startNs = 0;
+ static unsigned pinLevels = 0;
+
+ // Replayed button waveform
+ typedef struct {
+     double us;
+     int level;
+ } SimEdge;
+ static SimEdge* edges;
+ static int edgeCount = 0, edgeIndex = 0, replayLevel = 0;
+
+ // HD44780 model
+ static int lcd8Bit = 1;         // Controller powers up in 8-bit mode
+ static int lcdHaveHigh = 0;
+ static unsigned char lcdHigh;
+ static int lcdAddr = 0;
+ static char lcdDdram[2][LCD_COLS];
+ static unsigned long lcdBytes = 0, ledWrites = 0;
+
+ // Timing contract
+ static double enRiseUs = -1e9;
+ static double lcdBusyFrom = 0, lcdBusyUs = 0;   // Last instruction and how long it runs
+ static int wakeWrites = 0;         // 8-bit writes so far
+ static unsigned long timingViolations = 0;
+ static char timingFirst[96] = "";
+ static double realStartNs;
+
+ static double simNowUs(void) {
+     return (clockNowNs() - startNs) / 1000.0;
+ }
+
+ static double realNowNs(void) {
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return ts.tv_sec * 1e9 + ts.tv_nsec;
+ }
+
+ static void timingViolation(const char* what, double us, double need) {
+     if (timingViolations++ == 0) {
+         snprintf(timingFirst, sizeof(timingFirst), "%s: %.2f us < %.2f us at %.1f ms",
+                  what, us, need, simNowUs() / 1000.0);
+     }
+ }
+
+ // Load the press script named by MM_SIM_SCRIPT
+ static void loadScript(void) {
+     const char* path = getenv("MM_SIM_SCRIPT");
+     char line[128];
+     FILE* f;
+
+     if (path == NULL || (f = fopen(path, "r")) == NULL) {
+         fprintf(stderr, "sim: no press script (set MM_SIM_SCRIPT)\n");
+         return;
+     }
+     while (fgets(line, sizeof(line), f) != NULL && pressCount < SIM_MAX_PRESSES) {
+         SimPress* p = &presses[pressCount];
+         if (line[0] == '#' || sscanf(line, "%lf %lf", &p->delayMs, &p->holdMs) != 2) continue;
+         p->startUs = p->ledUs = p->lcdUs = -1;
+         pressCount++;
+     }
+     fclose(f);
+ }
+
+ // Load the button edges of the GPIO trace named by MM_SIM_REPLAY, and turn
+ // them into presses (bounces included) for the latency report
+ static void loadReplay(const char* path) {
+     GtraceHeader hdr;
+     GtraceEvent* ev;
+     int n = gtraceLoad(path, &hdr, &ev);
+     if (n < 0) return;
+
+     edges = malloc(sizeof(SimEdge) * (n > 0 ? n : 1));
+     if (edges == NULL) {
+         free(ev);
+         return;
+     }
+     int level = 0;
+     double lastFall = -1e12;
+     for (int i = 0; i < n; i++) {
+         if (ev[i].kind != GTRACE_LEV || (int)((ev[i].bits >> BUTTON) & 1) == level) continue;
+         level = !level;
+         double us = ev[i].ns / 1000.0;
+         edges[edgeCount].us = us;
+         edges[edgeCount].level = level;
+         edgeCount++;
+
+         if (level && us - lastFall >= SIM_REPLAY_SETTLE_MS * 1000.0 && pressCount < SIM_MAX_PRESSES) {
+             SimPress* p = &presses[pressCount++];
+             p->delayMs = (us - (pressCount > 1 ? lastFall : 0)) / 1000.0;
+             p->startUs = us;
+             p->holdMs = 0;
+             p->ledUs = p->lcdUs = -1;
+         } else if (!level) {
+             lastFall = us;
+             if (pressCount > 0) presses[pressCount - 1].holdMs = (us - presses[pressCount - 1].startUs) / 1000.0;
+         }
+     }
+     free(ev);
+     if (edgeCount == 0) fprintf(stderr, "sim: %s has no button edges\n", path);
+     fprintf(stderr, "sim: replaying %d button edges (%d presses) from %s\n", edgeCount, pressCount, path);
+ }
+
+ // Note the first LED/LCD output after the current press began
+ static void outputEvent(int isLcd) {
+     double now = simNowUs();
+     // Latest press that has started
+     int i = pressIndex;
+     if (i >= pressCount || presses[i].startUs < 0 || now < presses[i].startUs) i--;
+     if (i < 0) return;
+
+     SimPress* p = &presses[i];
+     double* slot = isLcd ? &p->lcdUs : &p->ledUs;
+     if (*slot < 0) *slot = now - p->startUs;
+ }
+
+ // Apply one byte to the DDRAM model
+ static void lcdApply(unsigned char byte, int data) {
+     double exec = LCD_EXEC_US;
+     if (lcd8Bit && !data) {
+         // Wake-up sequence: 4.1 ms after the first write, 100 us after the second
+         exec = wakeWrites == 0 ? 4100.0 : wakeWrites == 1 ? 100.0 : LCD_EXEC_US;
+         wakeWrites++;
+     } else if (!data && (byte == 0x01 || (byte & 0xFE) == 0x02)) {
+         exec = LCD_EXEC_LONG_US;
+     }
+     lcdBusyFrom = simNowUs();
+     lcdBusyUs = exec;
+
+     lcdBytes++;
+     outputEvent(1);
+     if (data) {
+         if (lcdAddr < 0x40) {
+             if (lcdAddr < LCD_COLS) lcdDdram[0][lcdAddr] = byte;
+         } else if (lcdAddr - 0x40 < LCD_COLS) {
+             lcdDdram[1][lcdAddr - 0x40] = byte;
+         }
+         lcdAddr++;
+     } else if (byte == 0x01) {
+         memset(lcdDdram, ' ', sizeof(lcdDdram));
+         lcdAddr = 0;
+     } else if (byte & 0x80) {
+         lcdAddr = byte & 0x7F;
+     } else if ((byte & 0xF0) == 0x20) {
+         lcd8Bit = 0; // Function set, 4-bit interface
+     }
+ }
+
+ static void lcdLatch(void) {
+     unsigned char nibble = ((pinLevels >> LCD_D4) & 1) | (((pinLevels >> LCD_D5) & 1) << 1) |
+                            (((pinLevels >> LCD_D6) & 1) << 2) | (((pinLevels >> LCD_D7) & 1) << 3);
+     int data = (pinLevels >> LCD_RS) & 1;
+
+     if (lcd8Bit) {
+         // Only D7-D4 are wired, so an 8-bit transfer carries one nibble
+         lcdApply(nibble << 4, data);
+         lcdHaveHigh = 0;
+     } else if (!lcdHaveHigh) {
+         lcdHigh = nibble;
+         lcdHaveHigh = 1;
+     } else {
+         lcdApply((lcdHigh << 4) | nibble, data);
+         lcdHaveHigh = 0;
+     }
+ }
+
+ static void jsonLatency(FILE* out, const char* name, int lcd) {
+     double v[SIM_MAX_PRESSES];
+     int n = 0;
+     for (int i = 0; i < pressCount; i++) {
+         double x = lcd ? presses[i].lcdUs : presses[i].ledUs;
+         if (x >= 0) {
+             // Insertion sort, the lists are short
+             int j = n++;
+             while (j > 0 && v[j - 1] > x) {
+                 v[j] = v[j - 1];
+                 j--;
+             }
+             v[j] = x;
+         }
+     }
+     fprintf(out, "  \"%s\": {\"count\": %d", name, n);
+     if (n > 0) {
+         fprintf(out, ", \"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f",
+                 v[(n - 1) / 2], v[(int)((n - 1) * 0.99)], v[n - 1]);
+     }
+     fprintf(out, "},\n");
+ }
+
+ // Write the results when the game exits
+ static void simReport(void) {
+     const char* path = getenv("MM_SIM_JSON");
+     FILE* out = path ? fopen(path, "w") : stderr;
+     if (out == NULL) out = stderr;
+
+     fprintf(out, "{\n  \"game_wall_ms\": %.1f,\n", simNowUs() / 1000.0);
+     fprintf(out, "  \"clock\": \"%s\",\n  \"real_ms\": %.1f,\n",
+             clockVirtual ? "virtual" : "real", (realNowNs() - realStartNs) / 1e6);
+     fprintf(out, "  \"timing_violations\": %lu,\n  \"timing_first\": \"%s\",\n",
+             timingViolations, timingFirst);
+     fprintf(out, "  \"presses_scripted\": %d,\n  \"presses_used\": %d,\n", pressCount,
+             pressIndex < pressCount && presses[pressIndex].startUs >= 0 ? pressIndex + 1 : pressIndex);
+     fprintf(out, "  \"lcd_bytes\": %lu,\n  \"led_writes\": %lu,\n", lcdBytes, ledWrites);
+     jsonLatency(out, "press_to_led_us", 0);
+     jsonLatency(out, "press_to_lcd_us", 1);
+     fprintf(out, "  \"lcd\": [\"%.16s\", \"%.16s\"],\n", lcdDdram[0], lcdDdram[1]);
+     fprintf(out, "  \"presses\": [\n");
+     for (int i = 0; i < pressCount; i++) {
+         fprintf(out, "    {\"start_ms\": %.3f, \"hold_ms\": %.1f, \"led_us\": %.1f, \"lcd_us\": %.1f}%s\n",
+                 presses[i].startUs / 1000.0, presses[i].holdMs,
+                 presses[i].ledUs, presses[i].lcdUs, i + 1 < pressCount ? "," : "");
+     }
+     fprintf(out, "  ]\n}\n");
+     if (out != stderr) fclose(out);
+ }
+
+ // Initialize GPIO: start the clock and load the script
+ int initGPIO() {
+     startNs = clockNowNs();
+     realStartNs = realNowNs();
+     memset(lcdDdram, ' ', sizeof(lcdDdram));
+     if (getenv("MM_SIM_REPLAY") != NULL) {
+         loadReplay(getenv("MM_SIM_REPLAY"));
+     } else {
+         loadScript();
+     }
+     atexit(simReport);
+     return 1;
+ }
+
+ // Clean up GPIO
+ void cleanupGPIO() {
+     digitalWrite(GREEN_LED, 0);
+     digitalWrite(RED_LED, 0);
+ }
+
+ // Set pin mode (INPUT or OUTPUT)
+ void pinMode(int pin, int mode) {
+ }
+
+ // React to a change of the pin levels: LED output, EN edges of the LCD bus
+ static void pinsChanged(unsigned old, unsigned written) {
+     unsigned en = 1u << LCD_EN;
+     if (written & ((1u << GREEN_LED) | (1u << RED_LED))) {
+         ledWrites++;
+         if (old != pinLevels) outputEvent(0);
+     }
+     if (!(old & en) && (pinLevels & en)) {
+         double now = simNowUs();
+         if (now - enRiseUs < LCD_EN_CYCLE_MIN) timingViolation("EN cycle", now - enRiseUs, LCD_EN_CYCLE_MIN);
+         if (now - lcdBusyFrom < lcdBusyUs) timingViolation("busy", now - lcdBusyFrom, lcdBusyUs);
+         enRiseUs = now;
+     } else if ((old & en) && !(pinLevels & en)) {
+         double high = simNowUs() - enRiseUs;
+         if (high < LCD_EN_HIGH_MIN) timingViolation("EN high", high, LCD_EN_HIGH_MIN);
+         lcdLatch();
+     }
+ }
+
+ // Write digital value to pin
+ void digitalWrite(int pin, int value) {
+     unsigned old = pinLevels;
+     ioCounters.gpioWrites++;
+     if (value) {
+         pinLevels |= 1u << pin;
+     } else {
+         pinLevels &= ~(1u << pin);
+     }
+
+     GTRACE_WRITE(pin, value);
+     pinsChanged(old, 1u << pin);
+ }
+
+ // A GPSET0 store then a GPCLR0 store, as display list replay does
+ void writePins(unsigned set, unsigned clr) {
+     unsigned old = pinLevels;
+     ioCounters.gpioWrites++;
+     pinLevels = (pinLevels | set) & ~clr;
+
+     for (unsigned bits = set | clr; bits != 0; bits &= bits - 1) {
+         int pin = __builtin_ctz(bits);
+         GTRACE_WRITE(pin, (set >> pin) & 1);
+     }
+     pinsChanged(old, set | clr);
+ }
+
+ // Both LEDs at once, as the real driver does with one GPSET and one GPCLR
+ void writeLEDs(int green, int red) {
+     unsigned old = pinLevels;
+     ioCounters.gpioWrites++;
+     pinLevels &= ~((1u << GREEN_LED) | (1u << RED_LED));
+     pinLevels |= (green ? 1u << GREEN_LED : 0) | (red ? 1u << RED_LED : 0);
+
+     GTRACE_WRITE(GREEN_LED, green);
+     GTRACE_WRITE(RED_LED, red);
+
+     ledWrites++;
+     if (old != pinLevels) outputEvent(0);
+ }
+
+ // Button level at the current time
+ static int buttonLevel(void) {
+     double now = simNowUs();
+     if (edges != NULL) {
+         while (edgeIndex < edgeCount && edges[edgeIndex].us <= now) {
+             replayLevel = edges[edgeIndex++].level;
+         }
+         while (pressIndex + 1 < pressCount && presses[pressIndex + 1].startUs <= now) {
+             pressIndex++;
+         }
+         return replayLevel;
+     }
+     while (pressIndex < pressCount) {
+         SimPress* p = &presses[pressIndex];
+         if (p->startUs < 0) {
+             // Scheduled start, relative to the previous release
+             double start = pressEnd + p->delayMs * 1000.0;
+             if (now < start) return 0;
+             p->startUs = start;
+         }
+         if (now < p->startUs + p->holdMs * 1000.0) return 1;
+         pressEnd = p->startUs + p->holdMs * 1000.0;
+         pressIndex++;
+     }
+     return 0;
+ }
+
+ // Read digital value from pin: the button follows the script or the replay
+ int digitalRead(int pin) {
+     static int lastButton = 0;
+     if (pin != BUTTON) return (pinLevels >> pin) & 1;
+
+     int level = buttonLevel();
+     if (gtraceEnabled && level != lastButton) {
+         // Polled levels stand in for the GPLEV0 sampler in a GPIO trace
+         gtraceSample(pinLevels | (unsigned)level << BUTTON);
+     }
+     lastButton = level;
+     return level;
+ }
+
+ // No register mapping to sample, digitalRead feeds the GPIO trace instead
+ volatile unsigned* gpioRegisters() {
+     return NULL;
+ }
+
+ // The LCD stays in power-on state between simulated runs
+ int lcdMarkerValid() {
+     return 0;
+ }
+
+ void lcdWriteMarker() {
+ }
@@ -0,0 +1,190 @@
+/*
+  Plays games on big boards with the local-search solver (mm-solver.c)
+
+$ make mm-solve
+$ ./mm-solve -p 8 -c 10 -n 20
+
+  Every game draws a random secret, lets the solver guess until it hits the
+  secret or runs out of attempts, and scores each guess with a generated
+  kernel (or matchesASM when the geometry has none). Reports the games won,
+  the mean number of guesses, and the time per move.
+
+  With -x the exact set of codes still consistent with the answers is kept
+  as a compressed candidate set (mm-cset.c) beside the search, and once it
+  is small the best guess for it (mm-tcache.c) is played instead of the
+  search's guess. The set sizes and the memory they take are reported; the
+  first filter scores the whole board, so on 8x10 expect it to take a few
+  seconds. Each game's solver and sets come from an arena (mm-arena.c)
+  that is reset between games. Best guesses are cached by position, and
+  -C keeps the cache in a file between runs:
+
+$ ./mm-solve -p 4 -c 6 -n 1000 -x -C hints.bin
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "mm-solver.h"
+#include "mm-cset.h"
+#include "mm-tcache.h"
+#include "mm-arena.h"
+#include "mm-kernels.h"
+#include "mm-trace.h"
+#include "mm-rng.h"
+
+extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
+
+static TraceHistogram moveTime;
+
+#define EXACT_PLAY_MAX 4096   // Play from the candidate set below this size
+#define SOLVE_ARENA_BYTES (64u << 20)
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void showSeq(const int *seq, int length) {
+  for (int i = 0; i < length; i++)
+    printf("%d", seq[i]);
+}
+
+int main (int argc, char **argv) {
+  int pegs = 8, colors = 10, games = 10, attempts = 12, verbose = 0, exactSet = 0;
+  unsigned long long seed = 1701;
+  const char *cachePath = NULL;
+  int opt;
+  Rng rng;
+
+  while ((opt = getopt(argc, argv, "p:c:n:a:s:vxC:")) != -1) {
+    switch (opt) {
+    case 'p':
+      pegs = atoi(optarg);
+      break;
+    case 'c':
+      colors = atoi(optarg);
+      break;
+    case 'n':
+      games = atoi(optarg);
+      break;
+    case 'a':
+      attempts = atoi(optarg);
+      break;
+    case 's':
+      seed = strtoull(optarg, NULL, 10);
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    case 'x':
+      exactSet = 1;
+      break;
+    case 'C':
+      cachePath = optarg;
+      break;
+    default: /* '?' */
+      fprintf(stderr, "Usage: %s [-p <pegs>] [-c <colours>] [-n <games>] [-a <attempts>] [-s <seed>] [-v] [-x] [-C <file>]\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (attempts > SOLVER_MAX_HISTORY) attempts = SOLVER_MAX_HISTORY;
+
+  MatchKernel kernel = findKernel(pegs, colors);
+  rngSeed(&rng, seed);
+
+  Arena arena;
+  if (!arenaCreate(&arena, SOLVE_ARENA_BYTES))
+    exit(EXIT_FAILURE);
+  arenaBind(&arena);
+
+  TCache *cache = NULL;
+  if (exactSet) {
+    cache = tcacheCreate(TCACHE_DEFAULT_BYTES);
+    if (cache == NULL)
+      exit(EXIT_FAILURE);
+    if (cachePath != NULL && access(cachePath, F_OK) == 0 && !tcacheLoad(cache, cachePath))
+      exit(EXIT_FAILURE);
+  }
+
+  int won = 0, guesses = 0, fallbacks = 0, fromSet = 0;
+  size_t peakBytes = 0;
+  for (int g = 0; g < games; g++) {
+    arenaReset(&arena);
+    Cset *cands = NULL;
+    if (exactSet && (cands = csetFull(pegs, colors)) == NULL)
+      exit(EXIT_FAILURE);
+    int secret[SOLVER_MAX_PEGS], guess[SOLVER_MAX_PEGS], exact = 0, approx;
+    Solver *s = solverCreate(pegs, colors, rngNext(&rng) | (uint64_t)rngNext(&rng) << 32);
+    if (s == NULL)
+      exit(EXIT_FAILURE);
+
+    rngSecrets(&rng, secret, 1, pegs, colors);
+    int turn;
+    for (turn = 1; turn <= attempts; turn++) {
+      uint64_t t1 = nowNs();
+      uint64_t bound;
+      if (cands != NULL && csetCardinality(cands) <= EXACT_PLAY_MAX &&
+          tcacheHint(cache, cands, attempts - turn + 1, guess, &bound)) {
+        fromSet++;
+      } else {
+        fallbacks += !solverNextGuess(s, guess);
+      }
+      histRecord(&moveTime, nowNs() - t1);
+
+      if (kernel != NULL)
+        kernel(secret, guess, &exact, &approx);
+      else
+        matchesASM(secret, guess, pegs, &exact, &approx);
+      if (exactSet) {
+        Cset *next = csetFilter(cands, guess, exact, approx);
+        if (next == NULL)
+          exit(EXIT_FAILURE);
+        csetFree(cands);
+        cands = next;
+        if (csetBytes(cands) > peakBytes)
+          peakBytes = csetBytes(cands);
+      }
+      if (verbose) {
+        printf("  ");
+        showSeq(guess, pegs);
+        printf(" %d %d (%ld steps)", exact, approx, s->steps);
+        if (cands != NULL)
+          printf(" %llu candidates in %zu bytes",
+                 (unsigned long long)csetCardinality(cands), csetBytes(cands));
+        printf("\n");
+      }
+      if (exact == pegs || !solverAddResult(s, guess, exact, approx))
+        break;
+    }
+    if (exact == pegs) {
+      won++;
+      guesses += turn;
+    }
+    if (verbose) {
+      printf("Game %d: secret ", g + 1);
+      showSeq(secret, pegs);
+      printf(exact == pegs ? ", solved in %d\n" : ", not solved\n", turn);
+    }
+    solverFree(s);
+    csetFree(cands);
+  }
+
+  printf("%dx%d: %d/%d games solved in %d attempts, %.2f guesses on average\n",
+         pegs, colors, won, games, attempts, won ? (double)guesses / won : 0.0);
+  printf("move time (ms): p50 %.2f  p99 %.2f  max %.2f  (%d moves without a consistent code)\n",
+         histPercentile(&moveTime, 0.50) / 1e6, histPercentile(&moveTime, 0.99) / 1e6,
+         moveTime.max / 1e6, fallbacks);
+  if (exactSet) {
+    printf("candidate sets: %d moves played from the set, peak %zu bytes\n", fromSet, peakBytes);
+    printf("hint cache: %llu hits, %llu misses, %llu evictions\n",
+           (unsigned long long)cache->hits, (unsigned long long)cache->misses,
+           (unsigned long long)cache->evictions);
+    if (cachePath != NULL && !tcacheSave(cache, cachePath))
+      exit(EXIT_FAILURE);
+    tcacheFree(cache);
+  }
+  return won == games ? 0 : 1;
+}
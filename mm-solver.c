@@ -0,0 +1,228 @@
+/*
+ * Local-search solver for boards too big to enumerate
+ * For F28HS Coursework 2
+ *
+ * 8 pegs x 10 colours has 10^8 codes, so instead of keeping the set of
+ * codes that fit the history, a population of candidates is moved towards
+ * consistency by single-peg mutations and crossover. A candidate carries,
+ * for every past guess, the exact count and the colour overlap it would
+ * have scored; changing one peg updates both in O(1) per guess instead of
+ * rescoring, which is what keeps a move in the millisecond range.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "mm-solver.h"
+ #include "mm-arena.h"
+
+ // Steps per move before falling back to the best candidate found
+ #define SOLVER_DEFAULT_STEPS 2000000
+
+ // One step in this many is a crossover, the rest are mutations
+ #define SOLVER_CROSSOVER_RATE 16
+
+ // A mutation that makes things worse is kept one time in this many
+ #define SOLVER_UPHILL_RATE 32
+
+ // A candidate that has not improved for this many of its steps is restarted
+ #define SOLVER_STALL_STEPS 4000
+
+ static int absDiff(int a, int b) {
+     return a > b ? a - b : b - a;
+ }
+
+ // Score a candidate against history column k (its colour histogram must be
+ // up to date), returns that column's share of the fitness
+ static int candidateScoreColumn(const Solver* s, SolverCandidate* c, int k) {
+     const SolverHistory* h = &s->history;
+     int exact = 0, common = 0;
+
+     for (int p = 0; p < s->pegs; p++) {
+         exact += c->peg[p] == h->guess[p][k];
+     }
+     for (int col = 1; col <= s->colors; col++) {
+         int a = c->colors[col], b = h->colors[col][k];
+         common += a < b ? a : b;
+     }
+     c->exact[k] = exact;
+     c->common[k] = common;
+     return absDiff(exact, h->exact[k]) + absDiff(common, h->total[k]);
+ }
+
+ // Score a candidate against the whole history from scratch
+ static void candidateScore(const Solver* s, SolverCandidate* c) {
+     int fitness = 0;
+
+     memset(c->colors, 0, sizeof(c->colors));
+     for (int p = 0; p < s->pegs; p++) {
+         c->colors[c->peg[p]]++;
+     }
+     for (int k = 0; k < s->history.count; k++) {
+         fitness += candidateScoreColumn(s, c, k);
+     }
+     c->fitness = fitness;
+ }
+
+ static void candidateRandom(Solver* s, SolverCandidate* c) {
+     for (int p = 0; p < s->pegs; p++) {
+         c->peg[p] = rngBounded(&s->rng, s->colors) + 1;
+     }
+     candidateScore(s, c);
+ }
+
+ // Set peg p to colour b, updating every history column incrementally
+ static void candidateSet(const Solver* s, SolverCandidate* c, int p, int b) {
+     const SolverHistory* h = &s->history;
+     int a = c->peg[p];
+     const uint8_t* gp = h->guess[p];
+     const uint8_t* ha = h->colors[a];
+     const uint8_t* hb = h->colors[b];
+     int ca = c->colors[a], cb = c->colors[b];
+     int fitness = 0;
+
+     // Losing one a lowers the overlap if we had no more a's than the guess;
+     // gaining one b raises it if we had fewer b's than the guess
+     for (int k = 0; k < h->count; k++) {
+         int exact = c->exact[k] + (gp[k] == b) - (gp[k] == a);
+         int common = c->common[k] - (ca <= ha[k]) + (cb < hb[k]);
+         c->exact[k] = exact;
+         c->common[k] = common;
+         fitness += absDiff(exact, h->exact[k]) + absDiff(common, h->total[k]);
+     }
+     c->colors[a]--;
+     c->colors[b]++;
+     c->peg[p] = b;
+     c->fitness = fitness;
+ }
+
+ // Uniform crossover of two parents into child
+ static void candidateCross(Solver* s, const SolverCandidate* x, const SolverCandidate* y,
+                            SolverCandidate* child) {
+     uint32_t bits = rngNext(&s->rng);
+     for (int p = 0; p < s->pegs; p++) {
+         child->peg[p] = (bits >> p) & 1 ? x->peg[p] : y->peg[p];
+     }
+     candidateScore(s, child);
+ }
+
+ // Create a solver for a board geometry, returns NULL if it is too big
+ Solver* solverCreate(int pegs, int colors, uint64_t seed) {
+     if (pegs < 1 || pegs > SOLVER_MAX_PEGS || colors < 1 || colors > SOLVER_MAX_COLORS) {
+         fprintf(stderr, "Solver supports at most %d pegs and %d colours\n",
+                 SOLVER_MAX_PEGS, SOLVER_MAX_COLORS);
+         return NULL;
+     }
+     Solver* s = arenaCalloc(1, sizeof(Solver));
+     if (s == NULL) return NULL;
+
+     s->pegs = pegs;
+     s->colors = colors;
+     s->maxSteps = SOLVER_DEFAULT_STEPS;
+     rngSeed(&s->rng, seed);
+     for (int i = 0; i < SOLVER_POPULATION; i++) {
+         candidateRandom(s, &s->pop[i]);
+     }
+     return s;
+ }
+
+ void solverFree(Solver* s) {
+     arenaFree(s);
+ }
+
+ // Add the score of a guess to the history, returns 0 when the history is full
+ int solverAddResult(Solver* s, const int* guess, int exact, int approx) {
+     SolverHistory* h = &s->history;
+     int k = h->count;
+     if (k == SOLVER_MAX_HISTORY) return 0;
+
+     for (int col = 0; col <= s->colors; col++) {
+         h->colors[col][k] = 0;
+     }
+     for (int p = 0; p < s->pegs; p++) {
+         h->guess[p][k] = guess[p];
+         h->colors[guess[p]][k]++;
+     }
+     h->exact[k] = exact;
+     h->total[k] = exact + approx;
+     h->count++;
+
+     // The population keeps its codes, only the new column needs scoring
+     for (int i = 0; i < SOLVER_POPULATION; i++) {
+         s->pop[i].fitness += candidateScoreColumn(s, &s->pop[i], k);
+     }
+     return 1;
+ }
+
+ // Pick the next guess: a code consistent with the history if one is found
+ // within the step budget (returns 1), else the closest one seen (returns 0)
+ int solverNextGuess(Solver* s, int* guess) {
+     SolverCandidate* best = &s->pop[0];
+     int stall[SOLVER_POPULATION] = { 0 };
+     long step;
+
+     // Opening move: two pegs per colour covers the most colours at once
+     if (s->history.count == 0) {
+         for (int p = 0; p < s->pegs; p++) {
+             guess[p] = (p / 2) % s->colors + 1;
+         }
+         s->steps = 0;
+         return 1;
+     }
+
+     for (int i = 1; i < SOLVER_POPULATION; i++) {
+         if (s->pop[i].fitness < best->fitness) best = &s->pop[i];
+     }
+
+     for (step = 0; step < s->maxSteps && best->fitness > 0; step++) {
+         int i = step % SOLVER_POPULATION;
+         SolverCandidate* c = &s->pop[i];
+
+         if (rngBounded(&s->rng, SOLVER_CROSSOVER_RATE) == 0) {
+             // Child of this candidate and a random one replaces the worse parent
+             int j = rngBounded(&s->rng, SOLVER_POPULATION);
+             SolverCandidate child;
+             candidateCross(s, c, &s->pop[j], &child);
+             SolverCandidate* worse = c->fitness > s->pop[j].fitness ? c : &s->pop[j];
+             if (child.fitness <= worse->fitness) {
+                 *worse = child;
+                 stall[worse - s->pop] = 0;
+                 if (worse->fitness < best->fitness) best = worse;
+             }
+             continue;
+         }
+
+         if (s->colors == 1) break;
+         int p = rngBounded(&s->rng, s->pegs);
+         int a = c->peg[p];
+         int b = rngBounded(&s->rng, s->colors - 1) + 1;
+         if (b >= a) b++;
+
+         int old = c->fitness;
+         candidateSet(s, c, p, b);
+         if (c->fitness < old) {
+             stall[i] = 0;
+             if (c->fitness < best->fitness) best = c;
+         } else if (c->fitness > old && rngBounded(&s->rng, SOLVER_UPHILL_RATE) != 0) {
+             candidateSet(s, c, p, a);
+             if (++stall[i] > SOLVER_STALL_STEPS && c != best) {
+                 candidateRandom(s, c);
+                 stall[i] = 0;
+             }
+         } else {
+             stall[i]++;
+             if (c == best && c->fitness > old) {
+                 // Best one went uphill, find the new best
+                 for (int j = 0; j < SOLVER_POPULATION; j++) {
+                     if (s->pop[j].fitness < best->fitness) best = &s->pop[j];
+                 }
+             }
+         }
+     }
+     s->steps = step;
+
+     for (int p = 0; p < s->pegs; p++) {
+         guess[p] = best->peg[p];
+     }
+     return best->fitness == 0;
+ }
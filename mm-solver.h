@@ -0,0 +1,51 @@
+/*
+ * Local-search solver for boards too big to enumerate
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_SOLVER_H
+ #define MM_SOLVER_H
+
+ #include <stdint.h>
+ #include "mm-rng.h"
+
+ #define SOLVER_MAX_PEGS 8
+ #define SOLVER_MAX_COLORS 15
+ #define SOLVER_MAX_HISTORY 64
+ #define SOLVER_POPULATION 64
+
+ // Guess history, structure-of-arrays: one row per peg or colour, one
+ // column per past guess, so the consistency loops run along a row
+ typedef struct {
+     int count;
+     uint8_t guess[SOLVER_MAX_PEGS][SOLVER_MAX_HISTORY];         // Colour of each peg
+     uint8_t colors[SOLVER_MAX_COLORS + 1][SOLVER_MAX_HISTORY];  // Colour histogram
+     int16_t exact[SOLVER_MAX_HISTORY];                          // Score it got
+     int16_t total[SOLVER_MAX_HISTORY];                          // exact + approx
+ } SolverHistory;
+
+ // A candidate code and how it would have scored against every past guess
+ typedef struct {
+     uint8_t peg[SOLVER_MAX_PEGS];
+     uint8_t colors[SOLVER_MAX_COLORS + 1];
+     int16_t exact[SOLVER_MAX_HISTORY];
+     int16_t common[SOLVER_MAX_HISTORY];     // Sum over colours of min(candidate, guess)
+     int fitness;                            // Distance from the real scores, 0 = consistent
+ } SolverCandidate;
+
+ typedef struct {
+     int pegs, colors;
+     long maxSteps;                          // Search budget per move
+     long steps;                             // Steps used by the last move
+     Rng rng;
+     SolverHistory history;
+     SolverCandidate pop[SOLVER_POPULATION];
+ } Solver;
+
+ // Function prototypes for the solver
+ Solver* solverCreate(int pegs, int colors, uint64_t seed);
+ void solverFree(Solver* s);
+ int solverAddResult(Solver* s, const int* guess, int exact, int approx);
+ int solverNextGuess(Solver* s, int* guess);
+
+ #endif // MM_SOLVER_H
@@ -0,0 +1,192 @@
+/*
+ * Transposition cache of best guesses for candidate sets
+ * For F28HS Coursework 2
+ *
+ * Games keep reaching the same candidate sets (every game starts from the
+ * full board, and the same opening and answers lead to the same set), and
+ * finding the best guess for a set costs up to millions of scorings. The
+ * cache maps a hash of the set and the attempts left to the best guess and
+ * its bound, so a repeat position is answered by one bucket probe.
+ *
+ * The table is one allocation sized from a memory budget, split into
+ * buckets of TCACHE_WAYS entries. A store replaces the entry for the same
+ * key, else an empty one, else the one the bucket's CLOCK hand finds with
+ * its reference bit clear (hits set the bit). Nothing is locked: each entry
+ * stores key ^ data beside data, as in chess transposition tables, so an
+ * entry mixed from two racing stores does not verify and reads as a miss.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include "mm-tcache.h"
+
+ #define TCACHE_EMPTY(check, data) ((check) == 0 && (data) == 0)
+
+ TCache* tcacheCreate(size_t bytes) {
+     size_t perBucket = TCACHE_WAYS * (sizeof(TCacheEntry) + 1) + 1;
+     uint32_t buckets = 1;
+     while ((size_t)buckets * 2 * perBucket <= bytes && buckets < (1u << 30)) {
+         buckets *= 2;
+     }
+
+     TCache* c = calloc(1, sizeof(TCache));
+     if (c == NULL) return NULL;
+     c->buckets = buckets;
+     c->entries = calloc((size_t)buckets * TCACHE_WAYS, sizeof(TCacheEntry));
+     c->ref = calloc((size_t)buckets * TCACHE_WAYS, 1);
+     c->hand = calloc(buckets, 1);
+     if (c->entries == NULL || c->ref == NULL || c->hand == NULL) {
+         fprintf(stderr, "Transposition cache: cannot allocate %zu bytes\n", bytes);
+         tcacheFree(c);
+         return NULL;
+     }
+     return c;
+ }
+
+ void tcacheFree(TCache* c) {
+     if (c == NULL) return;
+     free(c->entries);
+     free(c->ref);
+     free(c->hand);
+     free(c);
+ }
+
+ // Key of a position; never 0, which marks an empty entry
+ uint64_t tcacheKey(const Cset* cands, int attemptsLeft) {
+     uint64_t key = csetHash(cands) ^ ((uint64_t)attemptsLeft * 0x9e3779b97f4a7c15ull);
+     return key ? key : 1;
+ }
+
+ static uint32_t bucketOf(const TCache* c, uint64_t key) {
+     return (uint32_t)(key >> 32 ^ key) & (c->buckets - 1);
+ }
+
+ int tcacheLookup(TCache* c, uint64_t key, uint32_t* code, uint32_t* bound) {
+     size_t base = (size_t)bucketOf(c, key) * TCACHE_WAYS;
+     for (int i = 0; i < TCACHE_WAYS; i++) {
+         TCacheEntry* e = &c->entries[base + i];
+         uint64_t data = __atomic_load_n(&e->data, __ATOMIC_RELAXED);
+         uint64_t check = __atomic_load_n(&e->check, __ATOMIC_RELAXED);
+         if (TCACHE_EMPTY(check, data) || (check ^ data) != key) continue;
+         __atomic_store_n(&c->ref[base + i], 1, __ATOMIC_RELAXED);
+         __atomic_fetch_add(&c->hits, 1, __ATOMIC_RELAXED);
+         *code = (uint32_t)data;
+         *bound = (uint32_t)(data >> 32);
+         return 1;
+     }
+     __atomic_fetch_add(&c->misses, 1, __ATOMIC_RELAXED);
+     return 0;
+ }
+
+ void tcacheStore(TCache* c, uint64_t key, uint32_t code, uint32_t bound) {
+     uint32_t b = bucketOf(c, key);
+     size_t base = (size_t)b * TCACHE_WAYS;
+     uint64_t data = (uint64_t)bound << 32 | code;
+     int slot = -1;
+
+     // Same key or an empty entry first
+     for (int i = 0; i < TCACHE_WAYS && slot < 0; i++) {
+         TCacheEntry* e = &c->entries[base + i];
+         uint64_t d = __atomic_load_n(&e->data, __ATOMIC_RELAXED);
+         uint64_t check = __atomic_load_n(&e->check, __ATOMIC_RELAXED);
+         if (TCACHE_EMPTY(check, d) || (check ^ d) == key) slot = i;
+     }
+
+     // Otherwise sweep the CLOCK hand: referenced entries get a second chance
+     if (slot < 0) {
+         uint8_t hand = __atomic_load_n(&c->hand[b], __ATOMIC_RELAXED);
+         for (int n = 0; n < 2 * TCACHE_WAYS; n++) {
+             int i = (hand + n) % TCACHE_WAYS;
+             if (!__atomic_exchange_n(&c->ref[base + i], 0, __ATOMIC_RELAXED) || n == 2 * TCACHE_WAYS - 1) {
+                 slot = i;
+                 break;
+             }
+         }
+         __atomic_store_n(&c->hand[b], (slot + 1) % TCACHE_WAYS, __ATOMIC_RELAXED);
+         __atomic_fetch_add(&c->evictions, 1, __ATOMIC_RELAXED);
+     }
+
+     TCacheEntry* e = &c->entries[base + slot];
+     __atomic_store_n(&e->data, data, __ATOMIC_RELAXED);
+     __atomic_store_n(&e->check, key ^ data, __ATOMIC_RELAXED);
+     __atomic_store_n(&c->ref[base + slot], 0, __ATOMIC_RELAXED);
+     __atomic_fetch_add(&c->stores, 1, __ATOMIC_RELAXED);
+ }
+
+ // Write the valid entries to path, returns 1 on success
+ int tcacheSave(const TCache* c, const char* path) {
+     FILE* f = fopen(path, "wb");
+     if (f == NULL) {
+         fprintf(stderr, "Transposition cache: cannot write %s\n", path);
+         return 0;
+     }
+
+     size_t total = (size_t)c->buckets * TCACHE_WAYS;
+     TCacheFileHeader hdr = { TCACHE_MAGIC, TCACHE_VERSION, 0, 0 };
+     for (size_t i = 0; i < total; i++) {
+         if (!TCACHE_EMPTY(c->entries[i].check, c->entries[i].data)) hdr.count++;
+     }
+
+     int ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+     for (size_t i = 0; i < total && ok; i++) {
+         const TCacheEntry* e = &c->entries[i];
+         if (TCACHE_EMPTY(e->check, e->data)) continue;
+         uint64_t pair[2] = { e->check ^ e->data, e->data };
+         ok = fwrite(pair, sizeof(pair), 1, f) == 1;
+     }
+     if (fclose(f) != 0) ok = 0;
+     if (!ok) fprintf(stderr, "Transposition cache: error writing %s\n", path);
+     return ok;
+ }
+
+ // Add the entries saved in path, returns 1 on success
+ int tcacheLoad(TCache* c, const char* path) {
+     FILE* f = fopen(path, "rb");
+     if (f == NULL) {
+         fprintf(stderr, "Transposition cache: cannot read %s\n", path);
+         return 0;
+     }
+
+     TCacheFileHeader hdr;
+     if (fread(&hdr, sizeof(hdr), 1, f) != 1 || hdr.magic != TCACHE_MAGIC ||
+         hdr.version != TCACHE_VERSION) {
+         fprintf(stderr, "Transposition cache: %s is not a cache file\n", path);
+         fclose(f);
+         return 0;
+     }
+
+     uint64_t pair[2];
+     uint32_t n = 0;
+     while (n < hdr.count && fread(pair, sizeof(pair), 1, f) == 1) {
+         tcacheStore(c, pair[0], (uint32_t)pair[1], (uint32_t)(pair[1] >> 32));
+         n++;
+     }
+     fclose(f);
+     if (n != hdr.count) {
+         fprintf(stderr, "Transposition cache: %s is truncated\n", path);
+         return 0;
+     }
+     return 1;
+ }
+
+ // Best next guess and its bound (the most candidates it can leave); the
+ // cache may be NULL. Returns 0 if there are no candidates
+ int tcacheHint(TCache* c, const Cset* cands, int attemptsLeft, int* guess, uint64_t* bound) {
+     uint64_t key = 0;
+     uint32_t code, b;
+
+     if (c != NULL) {
+         key = tcacheKey(cands, attemptsLeft);
+         if (tcacheLookup(c, key, &code, &b)) {
+             csetDecode(cands, code, guess);
+             *bound = b;
+             return 1;
+         }
+     }
+
+     if (!csetBestGuess(cands, guess, bound)) return 0;
+     if (c != NULL) {
+         tcacheStore(c, key, csetEncode(cands, guess), *bound > UINT32_MAX ? UINT32_MAX : (uint32_t)*bound);
+     }
+     return 1;
+ }
@@ -0,0 +1,54 @@
+/*
+ * Transposition cache of best guesses for candidate sets
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_TCACHE_H
+ #define MM_TCACHE_H
+
+ #include <stdint.h>
+ #include <stddef.h>
+ #include "mm-cset.h"
+
+ #define TCACHE_WAYS 4                   // Entries per bucket
+ #define TCACHE_DEFAULT_BYTES (4u << 20)
+ #define TCACHE_MAGIC 0x43544d4du        // "MMTC"
+ #define TCACHE_VERSION 1
+
+ // One slot. check holds key ^ data, so a slot torn by two writers (or
+ // read while one is writing) fails the check and is just a miss
+ typedef struct {
+     uint64_t check;
+     uint64_t data;                      // Guess code (low 32 bits) | bound (high 32)
+ } TCacheEntry;
+
+ typedef struct {
+     uint32_t buckets;                   // Power of two
+     TCacheEntry* entries;               // buckets * TCACHE_WAYS
+     uint8_t* ref;                       // CLOCK reference bit per entry
+     uint8_t* hand;                      // CLOCK hand per bucket
+     uint64_t hits, misses, stores, evictions;
+ } TCache;
+
+ // File header of a saved cache, followed by count (key, data) pairs
+ typedef struct {
+     uint32_t magic;
+     uint32_t version;
+     uint32_t count;
+     uint32_t pad;
+ } TCacheFileHeader;
+
+ // Function prototypes for the cache; lookups and stores may run from any
+ // number of threads at once
+ TCache* tcacheCreate(size_t bytes);
+ void tcacheFree(TCache* c);
+ uint64_t tcacheKey(const Cset* cands, int attemptsLeft);
+ int tcacheLookup(TCache* c, uint64_t key, uint32_t* code, uint32_t* bound);
+ void tcacheStore(TCache* c, uint64_t key, uint32_t code, uint32_t bound);
+ int tcacheSave(const TCache* c, const char* path);
+ int tcacheLoad(TCache* c, const char* path);
+
+ // Best next guess for a candidate set, from the cache if it was seen before
+ int tcacheHint(TCache* c, const Cset* cands, int attemptsLeft, int* guess, uint64_t* bound);
+
+ #endif // MM_TCACHE_H
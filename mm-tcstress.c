@@ -0,0 +1,223 @@
+/*
+  Stress and round-trip test of the lock-free transposition cache
+
+$ make test-tcache
+$ ./mm-tcstress [-t <threads>] [-n <ops per thread>] [-k <keys>]
+
+  Several threads hammer a deliberately small cache (a few buckets) with
+  lookups and stores of a small key space, so nearly every operation races
+  with another on the same entry. Each thread stores its own data for a
+  key, derived from the key and the thread number, so every hit can be
+  checked: the data must be exactly what some thread stored for that key.
+  A torn entry (check and data from different stores) must read as a miss,
+  never as a wrong hit. make test-tcache builds it with -fsanitize=thread,
+  which also reports any access to the table that is not atomic.
+
+  Then a cache too big to evict anything is filled, saved with tcacheSave,
+  loaded into a fresh cache with tcacheLoad, and every key must come back
+  with its data; a truncated file and a file with a bad header must fail
+  to load. Exits with status 1 on any failure.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "mm-tcache.h"
+
+#define MAX_THREADS 16
+#define STRESS_BYTES 512                // A handful of buckets
+#define ROUNDTRIP_KEYS 4096
+
+typedef struct {
+  pthread_t thread;
+  TCache *cache;
+  uint32_t id;
+  long ops, hits, bad;
+} Worker;
+
+static int numKeys = 64;
+
+// splitmix64 finaliser: keys and per-key data that look random
+static uint64_t mix (uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+static uint64_t keyOf (int k) {
+  return mix(k) | 1;                    // Never 0, an empty slot has check 0
+}
+
+// What writer w stores for key: both halves carry w, so a hit identifies it
+static void dataOf (uint64_t key, uint32_t w, uint32_t *code, uint32_t *bound) {
+  uint64_t h = mix(key);
+  *code = (uint32_t)h ^ w;
+  *bound = (uint32_t)(h >> 32) ^ w;
+}
+
+// A hit is good if its code and bound are the pair some writer stored for key
+static int goodHit (uint64_t key, uint32_t code, uint32_t bound) {
+  uint64_t h = mix(key);
+  uint32_t w = code ^ (uint32_t)h;
+  return w < MAX_THREADS && (bound ^ (uint32_t)(h >> 32)) == w;
+}
+
+static void *worker (void *arg) {
+  Worker *wk = arg;
+  uint64_t state = wk->id + 1;
+  for (long i = 0; i < wk->ops; i++) {
+    state = mix(state);
+    uint64_t key = keyOf(state % numKeys);
+    uint32_t code, bound;
+    if (state & (1ull << 40)) {
+      dataOf(key, wk->id, &code, &bound);
+      tcacheStore(wk->cache, key, code, bound);
+    } else if (tcacheLookup(wk->cache, key, &code, &bound)) {
+      wk->hits++;
+      if (!goodHit(key, code, bound))
+        wk->bad++;
+    }
+  }
+  return NULL;
+}
+
+static int stress (int threads, long ops) {
+  Worker wk[MAX_THREADS];
+  TCache *c = tcacheCreate(STRESS_BYTES);
+  long hits = 0, bad = 0;
+  if (c == NULL)
+    return 0;
+
+  for (int t = 0; t < threads; t++) {
+    wk[t] = (Worker){ .cache = c, .id = t, .ops = ops };
+    if (pthread_create(&wk[t].thread, NULL, worker, &wk[t]) != 0) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  }
+  for (int t = 0; t < threads; t++) {
+    pthread_join(wk[t].thread, NULL);
+    hits += wk[t].hits;
+    bad += wk[t].bad;
+  }
+
+  printf("Stress: %d threads x %ld ops on %u buckets, %d keys: %ld hits, %llu stores, %llu evictions, %ld bad hits\n",
+         threads, ops, c->buckets, numKeys, hits, (unsigned long long)c->stores,
+         (unsigned long long)c->evictions, bad);
+  tcacheFree(c);
+  return bad == 0 && hits > 0;
+}
+
+// Cut a file down to bytes
+static int truncateFile (const char *path, long bytes) {
+  return truncate(path, bytes) == 0;
+}
+
+static int roundTrip (void) {
+  char path[] = "/tmp/mm-tcstress-XXXXXX";
+  int fd = mkstemp(path), ok = 1;
+  if (fd < 0) {
+    perror("mkstemp");
+    return 0;
+  }
+  close(fd);
+
+  TCache *a = tcacheCreate(TCACHE_DEFAULT_BYTES), *b = tcacheCreate(TCACHE_DEFAULT_BYTES);
+  if (a == NULL || b == NULL)
+    return 0;
+  for (int k = 0; k < ROUNDTRIP_KEYS; k++) {
+    uint32_t code, bound;
+    dataOf(keyOf(k), k % MAX_THREADS, &code, &bound);
+    tcacheStore(a, keyOf(k), code, bound);
+  }
+
+  if (a->evictions != 0 || !tcacheSave(a, path) || !tcacheLoad(b, path)) {
+    fprintf(stderr, "Round trip: save or load failed\n");
+    ok = 0;
+  }
+  int found = 0;
+  for (int k = 0; k < ROUNDTRIP_KEYS && ok; k++) {
+    uint32_t code, bound, wantCode, wantBound;
+    dataOf(keyOf(k), k % MAX_THREADS, &wantCode, &wantBound);
+    if (tcacheLookup(b, keyOf(k), &code, &bound) && code == wantCode && bound == wantBound)
+      found++;
+  }
+  if (found != ROUNDTRIP_KEYS)
+    ok = 0;
+  printf("Round trip: %d of %d entries back after save and load\n", found, ROUNDTRIP_KEYS);
+
+  // A file cut short, and one with a bad header, must not load
+  TCache *d = tcacheCreate(TCACHE_DEFAULT_BYTES);
+  long full = sizeof(TCacheFileHeader) + ROUNDTRIP_KEYS * 2 * sizeof(uint64_t);
+  fprintf(stderr, "Round trip: the next two load errors are expected\n");
+  if (!truncateFile(path, full - 8) || tcacheLoad(d, path)) {
+    fprintf(stderr, "Round trip: a truncated file loaded\n");
+    ok = 0;
+  }
+  FILE *f = fopen(path, "r+b");
+  if (f == NULL || fwrite("JUNK", 4, 1, f) != 1 || fclose(f) != 0 || tcacheLoad(d, path)) {
+    fprintf(stderr, "Round trip: a file with a bad header loaded\n");
+    ok = 0;
+  }
+
+  unlink(path);
+  tcacheFree(a);
+  tcacheFree(b);
+  tcacheFree(d);
+  return ok;
+}
+
+// mm-cset.c scores through matchesASM, which this test never calls; a C
+// stand-in keeps it free of the ARM assembly, so it also builds on a PC
+int matchesASM (int *secret, int *guess, int length, int *exactMatches, int *approxMatches) {
+  int exact = 0, approx = 0, usedS[16] = { 0 }, usedG[16] = { 0 };
+  for (int i = 0; i < length; i++)
+    if (secret[i] == guess[i]) {
+      usedS[i] = usedG[i] = 1;
+      exact++;
+    }
+  for (int i = 0; i < length; i++)
+    for (int j = 0; j < length && !usedG[i]; j++)
+      if (!usedS[j] && secret[j] == guess[i]) {
+        usedS[j] = usedG[i] = 1;
+        approx++;
+      }
+  *exactMatches = exact;
+  *approxMatches = approx;
+  return exact;
+}
+
+int main (int argc, char **argv) {
+  int opt, threads = 4;
+  long ops = 1000000;
+
+  while ((opt = getopt(argc, argv, "t:n:k:")) != -1) {
+    switch (opt) {
+    case 't':
+      threads = atoi(optarg);
+      break;
+    case 'n':
+      ops = atol(optarg);
+      break;
+    case 'k':
+      numKeys = atoi(optarg);
+      break;
+    default: /* '?' */
+      fprintf(stderr, "Usage: %s [-t <threads>] [-n <ops per thread>] [-k <keys>]\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (threads < 1 || threads > MAX_THREADS || numKeys < 1) {
+    fprintf(stderr, "Between 1 and %d threads, at least one key\n", MAX_THREADS);
+    exit(EXIT_FAILURE);
+  }
+
+  int ok = stress(threads, ops);
+  ok &= roundTrip();
+  printf("%s\n", ok ? "test-tcache passed" : "test-tcache FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/*
+ * Latency tracepoints and histograms for the input-to-display pipeline
+ * For F28HS Coursework 2
+ *
+ * Each thread appends monotonic timestamps to its own ring buffer, so a
+ * tracepoint never takes a lock. The buffers are a fixed pool allocated by
+ * traceInit, before play, so a tracepoint never calls the allocator. Every stage also feeds an HDR-style
+ * (log-linear) histogram, which is what the report at exit is built from.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <stdint.h>
+ #include <time.h>
+ #include "mm-trace.h"
+
+ // Per-thread ring buffer size (events), must be a power of two
+ #define TRACE_BUFFER_EVENTS 1024
+ #define TRACE_MAX_THREADS 8     // Threads past this many are not traced
+
+ typedef struct {
+     uint64_t ns;
+     uint32_t stage;
+ } TraceEvent;
+
+ typedef struct TraceBuffer {
+     TraceEvent events[TRACE_BUFFER_EVENTS];
+     uint64_t head;              // Only written by the owning thread
+     uint64_t press_ns;          // Timestamp of the press that started the chain
+     uint64_t last_ns;           // Timestamp of the previous stage
+ } TraceBuffer;
+
+ // Histogram slot TRACE_PRESS holds the whole press-to-display latency,
+ // the other slots hold the time spent in that stage
+ static const char* stageNames[TRACE_NUM_STAGES] = {
+     "total", "echo", "debounce", "display"
+ };
+
+ // Global variables
+ int traceEnabled = 0;
+ static TraceBuffer* traceBuffers;       // Pool of TRACE_MAX_THREADS buffers
+ static int traceBuffersUsed;            // Taken from the pool so far
+ static __thread TraceBuffer* localBuffer;
+ static TraceHistogram stageHist[TRACE_NUM_STAGES];
+
+ // Monotonic time in nanoseconds
+ static uint64_t traceNow(void) {
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+ }
+
+ // Map a latency to its log-linear bucket
+ static int histBucket(uint64_t v) {
+     if (v < HIST_SUB) return (int)v;
+     int msb = 63 - __builtin_clzll(v);
+     int shift = msb - HIST_SUB_BITS;
+     return (shift + 1) * HIST_SUB + (int)((v >> shift) & (HIST_SUB - 1));
+ }
+
+ // Lowest latency that falls into a bucket
+ static uint64_t histValue(int idx) {
+     if (idx < HIST_SUB) return idx;
+     int shift = idx / HIST_SUB - 1;
+     return (uint64_t)(HIST_SUB + idx % HIST_SUB) << shift;
+ }
+
+ // Add one latency (ns) to a histogram, safe from any thread
+ void histRecord(TraceHistogram* h, uint64_t v) {
+     __atomic_fetch_add(&h->counts[histBucket(v)], 1, __ATOMIC_RELAXED);
+     __atomic_fetch_add(&h->total, 1, __ATOMIC_RELAXED);
+     uint64_t old = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+     while (v > old &&
+            !__atomic_compare_exchange_n(&h->max, &old, v, 1,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+         ;
+ }
+
+ // Value at quantile q (0..1) of a histogram
+ uint64_t histPercentile(const TraceHistogram* h, double q) {
+     uint64_t target = (uint64_t)(q * h->total + 0.5);
+     uint64_t seen = 0;
+     if (target == 0) target = 1;
+     for (int i = 0; i < HIST_BUCKETS; i++) {
+         seen += h->counts[i];
+         if (seen >= target) return histValue(i);
+     }
+     return h->max;
+ }
+
+ // The calling thread's buffer, taken from the pool on its first tracepoint;
+ // NULL once the pool is used up
+ static TraceBuffer* traceBuffer(void) {
+     if (localBuffer == NULL) {
+         int i = __atomic_fetch_add(&traceBuffersUsed, 1, __ATOMIC_RELAXED);
+         if (i >= TRACE_MAX_THREADS) return NULL;
+         localBuffer = &traceBuffers[i];
+     }
+     return localBuffer;
+ }
+
+ static void traceAtExit(void) {
+     traceReport(stderr);
+ }
+
+ // Allocate the buffer pool, give the calling thread the first one, enable
+ // tracing and dump the histograms when the program exits
+ void traceInit(void) {
+     traceBuffers = calloc(TRACE_MAX_THREADS, sizeof(TraceBuffer));
+     if (traceBuffers == NULL) {
+         fprintf(stderr, "Out of memory for the trace buffers, tracing off\n");
+         return;
+     }
+     traceBuffer();
+     traceEnabled = 1;
+     atexit(traceAtExit);
+ }
+
+ // Record that the calling thread reached a pipeline stage
+ void tracePoint(TraceStage stage) {
+     TraceBuffer* buf = traceBuffer();
+     if (buf == NULL) return;
+
+     uint64_t now = traceNow();
+     TraceEvent* ev = &buf->events[buf->head & (TRACE_BUFFER_EVENTS - 1)];
+     ev->ns = now;
+     ev->stage = stage;
+     buf->head++;
+
+     if (stage == TRACE_PRESS) {
+         buf->press_ns = now;
+     } else if (buf->press_ns != 0) {
+         histRecord(&stageHist[stage], now - buf->last_ns);
+         if (stage == TRACE_DISPLAY) {
+             histRecord(&stageHist[TRACE_PRESS], now - buf->press_ns);
+             buf->press_ns = 0;
+         }
+     }
+     buf->last_ns = now;
+ }
+
+ // Print p50/p99/max per stage, in microseconds
+ void traceReport(FILE* out) {
+     uint64_t events = 0;
+     int threads = __atomic_load_n(&traceBuffersUsed, __ATOMIC_RELAXED);
+     if (threads > TRACE_MAX_THREADS) threads = TRACE_MAX_THREADS;
+     for (int i = 0; i < threads; i++) {
+         events += traceBuffers[i].head;
+     }
+
+     fprintf(out, "Latency trace: %llu events from %d thread(s)\n",
+             (unsigned long long)events, threads);
+     fprintf(out, "%-10s %8s %12s %12s %12s\n", "stage", "count", "p50(us)", "p99(us)", "max(us)");
+     for (int s = 1; s <= TRACE_NUM_STAGES; s++) {
+         // Stages first, then the end-to-end total
+         const TraceHistogram* h = &stageHist[s % TRACE_NUM_STAGES];
+         fprintf(out, "%-10s %8llu %12.1f %12.1f %12.1f\n",
+                 stageNames[s % TRACE_NUM_STAGES],
+                 (unsigned long long)h->total,
+                 histPercentile(h, 0.50) / 1000.0,
+                 histPercentile(h, 0.99) / 1000.0,
+                 h->max / 1000.0);
+     }
+ }
@@ -0,0 +1,45 @@
+/*
+ * Latency tracepoints for the input-to-display pipeline
+ * For F28HS Coursework 2
+ */
+
+ #ifndef MM_TRACE_H
+ #define MM_TRACE_H
+
+ #include <stdio.h>
+ #include <stdint.h>
+
+ // Pipeline stages, in the order they happen after a button press
+ typedef enum {
+     TRACE_PRESS = 0,   // readButton() saw the press
+     TRACE_ECHO,        // blinkLED echoes finished
+     TRACE_DEBOUNCE,    // release wait and debounce sleeps finished
+     TRACE_DISPLAY,     // "Count: N" written to the LCD
+     TRACE_NUM_STAGES
+ } TraceStage;
+
+ // Histogram layout: 16 linear sub-buckets per power of two (~6% precision)
+ #define HIST_SUB_BITS 4
+ #define HIST_SUB (1 << HIST_SUB_BITS)
+ #define HIST_BUCKETS (64 * HIST_SUB)
+
+ // HDR-style latency histogram, also used by the load generator
+ typedef struct {
+     uint32_t counts[HIST_BUCKETS];
+     uint64_t total;
+     uint64_t max;
+ } TraceHistogram;
+
+ // Set by the -t option; tracepoints cost one load and a branch when off
+ extern int traceEnabled;
+
+ #define TRACE(stage) do { if (traceEnabled) tracePoint(stage); } while (0)
+
+ // Function prototypes for tracing
+ void traceInit(void);
+ void tracePoint(TraceStage stage);
+ void traceReport(FILE* out);
+ void histRecord(TraceHistogram* h, uint64_t v);
+ uint64_t histPercentile(const TraceHistogram* h, double q);
+
+ #endif // MM_TRACE_H
@@ -3,8 +3,12 @@
 
 $ as  -o mm-matches.o mm-matches.s
 $ gcc -c -o testm.o testm.c
-$ gcc -o testm testm.o matches.o
+$ gcc -c -o mm-arena.o mm-arena.c
+$ gcc -o testm testm.o mm-matches.o mm-arena.o
 $ ./testm
+
+  or, on any Linux box with an ARM cross toolchain and qemu-user:
+$ make arm/testm && qemu-arm arm/testm
 */
 
 #include <stdio.h>
@@ -12,6 +16,8 @@ $ ./testm
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/time.h>
+#include "mm-arena.h"
 
 #define LENGTH 3
 #define COLORS 3
@@ -26,37 +32,64 @@ const int seqmax = COLORS;
 /* take these fcts from master-mind.c */
 /* ********************************** */
 
-/* Show given sequence */
-void showSeq(int *seq);
-
-/* Parse an integer value as a list of digits of base MAX */
-void readSeq(int *seq, int val);
-
 /* display the sequence on the terminal window, using the format from the sample run in the spec */
-void showSeq(int *seq) ;
-
+void showSeq(int *seq) {
+  fprintf(stdout, "Seq:");
+  for (int i = 0; i < seqlen; i++)
+    fprintf(stdout, " %d", seq[i]);
+  fprintf(stdout, "\n");
+}
 
-#define NAN1 8
-#define NAN2 9
+/* parse an integer value as a list of digits, and put them into @seq@ */
+/* needed for processing command-line with options -s or -u            */
+void readSeq(int *seq, int val) {
+  for (int i = seqlen - 1; i >= 0; i--) {
+    seq[i] = val % 10;
+    val /= 10;
+  }
+}
 
 /* counts how many entries in seq2 match entries in seq1 */
-/* returns exact and approximate matches, either both encoded in one value, */
-/* or as a pointer to a pair of values */
-int /* or int* */ countMatches(int *seq1, int *seq2) ;
+/* returns exact and approximate matches encoded in one value, exact*10 + approx */
+int countMatches(int *seq1, int *seq2) {
+  int exact = 0, approx = 0;
+  int used1[LENGTH] = {0}, used2[LENGTH] = {0};
+
+  for (int i = 0; i < seqlen; i++)
+    if (seq1[i] == seq2[i]) {
+      used1[i] = used2[i] = 1;
+      exact++;
+    }
+  for (int i = 0; i < seqlen; i++) {
+    if (used1[i])
+      continue;
+    for (int j = 0; j < seqlen; j++)
+      if (!used2[j] && seq1[i] == seq2[j]) {
+        used1[i] = used2[j] = 1;
+        approx++;
+        break;
+      }
+  }
+  return exact * 10 + approx;
+}
 
 /* show the results from calling countMatches on seq1 and seq1 */
-void showMatches(int /* or int* */ code, /* only for debugging */ int *seq1, int *seq2, /* optional, to control layout */ int lcd_format);
-
-/* parse an integer value as a list of digits, and put them into @seq@ */
-/* needed for processing command-line with options -s or -u            */
-void readSeq(int *seq, int val) ;
+void showMatches(int code, /* only for debugging */ int *seq1, int *seq2, /* optional, to control layout */ int lcd_format) {
+  if (lcd_format)
+    fprintf(stdout, "%d exact\n%d approximate\n", code / 10, code % 10);
+  else
+    fprintf(stdout, "%d exact matches\n%d approximate matches\n", code / 10, code % 10);
+}
 
-/* read a guess sequence fron stdin and store the values in arr */
-/* only needed for testing the game logic, without button input */
-int readNum(int max); 
+// The ARM assembler version of the matching fct, in mm-matches.s
+extern int matchesASM(int* secret, int* guess, int length, int* exactMatches, int* approxMatches);
 
-// The ARM assembler version of the matching fct
-extern int /* or int* */ matches(int *val1, int *val2);
+/* the same encoding as countMatches, computed by matchesASM */
+int matches(int *val1, int *val2) {
+  int exact, approx;
+  matchesASM(val1, val2, seqlen, &exact, &approx);
+  return exact * 10 + approx;
+}
 
 // +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
@@ -64,6 +97,7 @@ int main (int argc, char **argv) {
   int res, res_c, t, t_c, m, n;
   int *seq1, *seq2, *cpy1, *cpy2;
   struct timeval t1, t2 ;
+  Arena arena;
   char str_in[20], str[20] = "some text";
   int verbose = 0, debug = 0, help = 0, opt_s = 0, opt_n = 0;
   
@@ -94,10 +128,18 @@ int main (int argc, char **argv) {
     }
   }
 
-  seq1 = (int*)malloc(seqlen*sizeof(int));
-  seq2 = (int*)malloc(seqlen*sizeof(int));
-  cpy1 = (int*)malloc(seqlen*sizeof(int));
-  cpy2 = (int*)malloc(seqlen*sizeof(int));
+  // all sequence buffers come from one arena, taken once;
+  // every allocation is rounded up to ARENA_ALIGN bytes
+  if (!arenaCreate(&arena, 4*(seqlen*sizeof(int) + ARENA_ALIGN)))
+    exit(EXIT_FAILURE);
+  seq1 = (int*)arenaAlloc(&arena, seqlen*sizeof(int));
+  seq2 = (int*)arenaAlloc(&arena, seqlen*sizeof(int));
+  cpy1 = (int*)arenaAlloc(&arena, seqlen*sizeof(int));
+  cpy2 = (int*)arenaAlloc(&arena, seqlen*sizeof(int));
+  if (seq1 == NULL || seq2 == NULL || cpy1 == NULL || cpy2 == NULL) {
+    fprintf(stderr, "Out of memory for the sequence buffers\n");
+    exit(EXIT_FAILURE);
+  }
   
   if (argc > optind+1) {
     strcpy(str_in, argv[optind]);
@@ -126,7 +168,7 @@ int main (int argc, char **argv) {
 	showSeq(seq1);
 	showSeq(seq2);
       }
-      res = matches(seq1, seq2);         // extern; code in matches.s
+      res = matches(seq1, seq2);         // code in mm-matches.s
       memcpy(seq1, cpy1, seqlen*sizeof(int));
       memcpy(seq2, cpy2, seqlen*sizeof(int));
       res_c = countMatches(seq1, seq2);  // local C function
@@ -179,7 +221,7 @@ int main (int argc, char **argv) {
   memcpy(seq2, cpy2, seqlen*sizeof(int));
   
   gettimeofday (&t1, NULL) ;
-  res = matches(seq1, seq2);         // extern; code in hamming4.s
+  res = matches(seq1, seq2);         // code in mm-matches.s
   gettimeofday (&t2, NULL) ;
   // d = difftime(t1,t2);
   if (t2.tv_usec < t1.tv_usec)	// Counter wrapped